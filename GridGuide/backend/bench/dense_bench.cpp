@@ -0,0 +1,105 @@
+// Times the dense Dijkstra kernels /api/dijkstra chooses between, on random
+// complete graphs in every cell type and layout a binary body can carry.
+// Usage: dense_bench [runs]   (median of runs, default 5)
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <shortest_path/layouts.hpp>
+#include <shortest_path/textbook.hpp>
+#include "dense.hpp"
+
+namespace {
+
+int runs = 5;
+
+// Binary /api/dijkstra body of a random complete undirected graph, weights 1..100
+template <typename Cell>
+std::string denseBody(uint32_t V, MatrixLayout layout, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<Cell> full(static_cast<size_t>(V) * V, 0);
+    std::vector<Cell> triangle;
+    for (size_t u = 0; u < V; ++u) {
+        for (size_t v = u + 1; v < V; ++v) {
+            const Cell w = static_cast<Cell>(weight(rng));
+            full[u * V + v] = full[v * V + u] = w;
+            triangle.push_back(w);
+        }
+    }
+    const std::vector<Cell>& cells = layout == MatrixLayout::UpperTriangle ? triangle : full;
+
+    const uint16_t width = sizeof(Cell);
+    const uint16_t layoutCode = static_cast<uint16_t>(layout);
+    std::string body(DenseMatrix::HEADER_BYTES + cells.size() * sizeof(Cell), '\0');
+    std::memcpy(&body[0], &V, 4);
+    std::memcpy(&body[4], &width, 2);
+    std::memcpy(&body[6], &layoutCode, 2);
+    std::memcpy(&body[DenseMatrix::HEADER_BYTES], cells.data(), cells.size() * sizeof(Cell));
+    return body;
+}
+
+// The Scalar kernel as /api/dijkstra runs it, without the JSON logging
+void textbookKernel(const DenseMatrix& graph, std::vector<int>& distances) {
+    auto visit = [](uint32_t, const std::vector<uint32_t>&) {};
+    graph.visit([&](const auto* cells, auto packed) {
+        using Cell = std::remove_const_t<std::remove_pointer_t<decltype(cells)>>;
+        if constexpr (decltype(packed)::value) {
+            const shortest_path::UpperTriangleLayout<Cell> layout(cells, graph.size());
+            shortest_path::textbookDijkstra(layout, 0, distances, visit);
+        } else {
+            const shortest_path::DenseLayout<Cell> layout(cells, graph.size());
+            shortest_path::textbookDijkstra(layout, 0, distances, visit);
+        }
+    });
+}
+
+void vectorKernel(const DenseMatrix& graph, std::vector<int>& distances) {
+    vectorDijkstra(graph, 0, distances, [](int, const std::vector<int>&) {});
+}
+
+// Median time of runs calls of kernel()
+template <typename Kernel>
+double median(Kernel&& kernel) {
+    std::vector<double> times;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        kernel();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+template <typename Cell>
+void bench(const char* name, uint32_t V, MatrixLayout layout) {
+    const std::string body = denseBody<Cell>(V, layout, V);
+    const DenseMatrix graph = DenseMatrix::fromBinary(body);
+    std::vector<int> scalarDistances, vectorDistances;
+    const double scalar = median([&] { textbookKernel(graph, scalarDistances); });
+    const double vector = median([&] { vectorKernel(graph, vectorDistances); });
+    std::printf("%-24s %6u %12.2f %12.2f %8.2fx %6s\n", name, V, scalar, vector, scalar / vector,
+                scalarDistances == vectorDistances ? "yes" : "NO");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1) runs = std::max(1, std::atoi(argv[1]));
+
+    std::printf("vectorDijkstra runs %s\n", avx2Available() ? "AVX2" : "plain loops (no AVX2 on this CPU)");
+    std::printf("%-24s %6s %12s %12s %9s %6s\n", "cells", "nodes", "scalar ms", "vector ms", "speedup", "same");
+    for (const uint32_t V : {1000u, 2000u, 4000u}) {
+        bench<int32_t>("int32", V, MatrixLayout::Full);
+        bench<uint16_t>("uint16", V, MatrixLayout::Full);
+        bench<int32_t>("int32 upper triangle", V, MatrixLayout::UpperTriangle);
+        bench<uint16_t>("uint16 upper triangle", V, MatrixLayout::UpperTriangle);
+    }
+    return 0;
+}
@@ -2,9 +2,12 @@
 #include <cpprest/filestream.h>
 #include <cpprest/http_listener.h>
 #include <cpprest/json.h>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <shortest_path/shortest_path.hpp>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -12,61 +15,43 @@ using namespace web;
 using namespace web::http;
 using namespace web::http::experimental::listener;
 
-// A utility function to find the vertex with minimum distance value, from
-// the set of vertices not yet processed.
-int minDistance(const std::vector<int> &dist, const std::vector<bool> &sptSet,
-                int V) {
-  int min = std::numeric_limits<int>::max(), min_index = -1;
-  for (int v = 0; v < V; v++)
-    if (!sptSet[v] && dist[v] <= min)
-      min = dist[v], min_index = v;
-  return min_index;
-}
-
+// Dijkstra's algorithm on the adjacency matrix, recording every iteration.
+// The loop itself is the textbook kernel of the shared shortest_path library.
 void dijkstra(const std::vector<std::vector<int>> &graph, int src,
               std::vector<int> &distances, json::value &iterations) {
-  int V = graph.size();
-  distances.assign(V, std::numeric_limits<int>::max());
-  std::vector<bool> sptSet(V, false); // sptSet[i] will be true if vertex i is
-                                      // included in shortest path tree
-
-  distances[src] = 0; // Distance of source vertex from itself is always 0
-
-  for (int count = 0; count < V - 1; count++) {
-    // Pick the minimum distance vertex from the set of vertices not yet
-    // processed.
-    int u = minDistance(distances, sptSet, V);
-    sptSet[u] = true;
-
-    // Record the current iteration
-    json::value iteration = json::value::object();
-    iteration["current_node"] = json::value::number(u);
-    json::value neighbors = json::value::array();
-    json::value updated_distances = json::value::array();
-
-    // Update dist value of the adjacent vertices of the picked vertex.
-    for (int v = 0; v < V; v++) {
-      // Update dist[v] only if it's not in sptSet, there is an edge from u to
-      // v, and total weight of path from src to v through u is smaller than the
-      // current value of dist[v]
-      if (!sptSet[v] && graph[u][v] &&
-          distances[u] != std::numeric_limits<int>::max() &&
-          distances[u] + graph[u][v] < distances[v]) {
-        distances[v] = distances[u] + graph[u][v];
-        neighbors[v] = json::value::number(1);
-      } else {
-        neighbors[v] = json::value::number(0);
-      }
-
-      // Track the neighbors visited and their updated distances
-
-      updated_distances[v] = json::value::number(distances[v]);
-    }
-
-    iteration["neighbors"] = neighbors;
-    iteration["updated_distances"] = updated_distances;
-    iterations[count] = iteration; // Store the iteration details
+  const size_t V = graph.size();
+
+  // The library reads the matrix as one row-major buffer
+  std::vector<int> cells;
+  cells.reserve(V * V);
+  for (const auto &row : graph) {
+    if (row.size() != V)
+      throw std::invalid_argument("matrix must be square");
+    cells.insert(cells.end(), row.begin(), row.end());
   }
+  const shortest_path::DenseLayout<int> layout(cells.data(), V);
+
+  int count = 0;
+  shortest_path::textbookDijkstra(
+      layout, static_cast<uint32_t>(src), distances,
+      [&](uint32_t u, const std::vector<uint32_t> &relaxed) {
+        // Record the current iteration: the nodes whose distance u lowered,
+        // and every distance after the update
+        json::value iteration = json::value::object();
+        iteration["current_node"] = json::value::number(static_cast<int>(u));
+        json::value neighbors = json::value::array();
+        json::value updated_distances = json::value::array();
+        for (size_t v = 0; v < V; v++) {
+          neighbors[v] = json::value::number(0);
+          updated_distances[v] = json::value::number(distances[v]);
+        }
+        for (uint32_t v : relaxed)
+          neighbors[v] = json::value::number(1);
+
+        iteration["neighbors"] = neighbors;
+        iteration["updated_distances"] = updated_distances;
+        iterations[count++] = iteration; // Store the iteration details
+      });
 }
 
 /* void handle_get(http_request request) {
@@ -0,0 +1,249 @@
+#include "compare.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <shortest_path/search.hpp>
+
+namespace {
+
+struct NamedAlgorithm {
+    const char *name;
+    Algorithm algorithm;
+};
+
+constexpr NamedAlgorithm ALGORITHMS[] = {
+    {"bfs", Algorithm::Bfs},
+    {"array_dijkstra", Algorithm::ArrayDijkstra},
+    {"heap_dijkstra", Algorithm::HeapDijkstra},
+    {"astar", Algorithm::AStar},
+    {"bidirectional", Algorithm::Bidirectional},
+    {"bellman_ford", Algorithm::BellmanFord},
+};
+
+using Entry = std::pair<int64_t, uint32_t>;
+using MinHeap = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+uint64_t countReached(const std::vector<int64_t> &distances) {
+    return std::count_if(distances.begin(), distances.end(), [](int64_t d) { return d != UNREACHABLE; });
+}
+
+ComparisonResult finish(SearchCounters counters, const std::vector<int64_t> &distances,
+                        const std::optional<uint32_t> &target) {
+    ComparisonResult result;
+    result.counters = counters;
+    result.reached = countReached(distances);
+    if (target) result.distance = distances[*target];
+    return result;
+}
+
+ComparisonResult bfs(const ComparisonInput &input) {
+    const CsrGraph &graph = input.graph();
+    const auto &target = input.target();
+    SearchCounters counters;
+    std::vector<int64_t> hops(graph.nodeCount(), UNREACHABLE);
+    std::vector<uint32_t> queue;
+    queue.reserve(graph.nodeCount());
+    hops[input.source()] = 0;
+    queue.push_back(input.source());
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const uint32_t u = queue[head];
+        ++counters.settled;
+        if (target && u == *target) break;
+        for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            ++counters.relaxations;
+            const uint32_t v = graph.targets[e];
+            if (hops[v] == UNREACHABLE) {
+                hops[v] = hops[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return finish(counters, hops, target);
+}
+
+// Array Dijkstra, heap Dijkstra or A*, whichever queue and heuristic the shared library is given
+template <template <typename> class Queue, typename Heuristic>
+ComparisonResult librarySearch(const ComparisonInput &input, const Heuristic &heuristic) {
+    const auto &target = input.target();
+    std::vector<int64_t> distances;
+    shortest_path::SearchVisitor visitor;
+    const shortest_path::SearchStats stats = shortest_path::search<int64_t, Queue>(
+        input.graph().layout(), input.source(), target.value_or(shortest_path::NO_TARGET), distances, heuristic,
+        visitor);
+    return finish({stats.settled, stats.relaxations, stats.queueOperations}, distances, target);
+}
+
+ComparisonResult bidirectional(const ComparisonInput &input) {
+    const uint32_t target = *input.target();
+    const size_t V = input.graph().nodeCount();
+    SearchCounters counters;
+
+    struct Side {
+        const CsrGraph *graph;
+        std::vector<int64_t> distances;
+        std::vector<bool> settled;
+        MinHeap heap;
+    };
+    Side sides[2] = {{&input.graph(), std::vector<int64_t>(V, UNREACHABLE), std::vector<bool>(V, false), {}},
+                     {&input.reverseGraph(), std::vector<int64_t>(V, UNREACHABLE), std::vector<bool>(V, false), {}}};
+    sides[0].distances[input.source()] = 0;
+    sides[0].heap.push({0, input.source()});
+    sides[1].distances[target] = 0;
+    sides[1].heap.push({0, target});
+    counters.heapOperations += 2;
+
+    int64_t best = input.source() == target ? 0 : UNREACHABLE;
+    auto top = [&counters](Side &side) {
+        // Drop stale entries so the top is a real lower bound for the side
+        while (!side.heap.empty() && side.settled[side.heap.top().second]) {
+            side.heap.pop();
+            ++counters.heapOperations;
+        }
+        return side.heap.empty() ? UNREACHABLE : side.heap.top().first;
+    };
+
+    for (;;) {
+        const int64_t forwardTop = top(sides[0]);
+        const int64_t backwardTop = top(sides[1]);
+        if (forwardTop == UNREACHABLE || backwardTop == UNREACHABLE) break;
+        // No path through an unsettled node can beat the best meeting point any more
+        if (best != UNREACHABLE && forwardTop + backwardTop >= best) break;
+
+        const int s = forwardTop <= backwardTop ? 0 : 1;
+        Side &side = sides[s];
+        const Side &other = sides[1 - s];
+        const auto [d, u] = side.heap.top();
+        side.heap.pop();
+        ++counters.heapOperations;
+        side.settled[u] = true;
+        ++counters.settled;
+
+        const CsrGraph &graph = *side.graph;
+        for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            ++counters.relaxations;
+            const uint32_t v = graph.targets[e];
+            const int64_t candidate = d + graph.weights[e];
+            if (!side.settled[v] && candidate < side.distances[v]) {
+                side.distances[v] = candidate;
+                side.heap.push({candidate, v});
+                ++counters.heapOperations;
+            }
+            if (other.distances[v] != UNREACHABLE) best = std::min(best, candidate + other.distances[v]);
+        }
+    }
+
+    ComparisonResult result;
+    result.counters = counters;
+    result.distance = best;
+    for (size_t v = 0; v < V; ++v) {
+        if (sides[0].distances[v] != UNREACHABLE || sides[1].distances[v] != UNREACHABLE) ++result.reached;
+    }
+    return result;
+}
+
+ComparisonResult bellmanFord(const ComparisonInput &input) {
+    const CsrGraph &graph = input.graph();
+    const size_t V = graph.nodeCount();
+    SearchCounters counters;
+    std::vector<int64_t> distances(V, UNREACHABLE);
+    distances[input.source()] = 0;
+
+    // Weights are never negative, so at most V - 1 rounds change anything
+    for (size_t round = 0; round + 1 < V; ++round) {
+        bool changed = false;
+        for (uint32_t u = 0; u < V; ++u) {
+            if (distances[u] == UNREACHABLE) continue;
+            for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                ++counters.relaxations;
+                const uint32_t v = graph.targets[e];
+                if (distances[u] + graph.weights[e] < distances[v]) {
+                    distances[v] = distances[u] + graph.weights[e];
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) break;
+    }
+    counters.settled = countReached(distances);
+    return finish(counters, distances, input.target());
+}
+
+} // namespace
+
+std::optional<Algorithm> parseAlgorithm(const std::string &name) {
+    for (const auto &entry : ALGORITHMS) {
+        if (name == entry.name) return entry.algorithm;
+    }
+    return std::nullopt;
+}
+
+const char *algorithmName(Algorithm algorithm) {
+    for (const auto &entry : ALGORITHMS) {
+        if (entry.algorithm == algorithm) return entry.name;
+    }
+    return "unknown";
+}
+
+ComparisonInput::ComparisonInput(CsrGraph graph, uint32_t source, std::optional<uint32_t> target,
+                                 std::vector<std::pair<double, double>> coordinates)
+    : forward(std::move(graph)), from(source), to(target), coordinates(std::move(coordinates)) {
+    const size_t V = forward.nodeCount();
+    if (source >= V) throw std::invalid_argument("source is out of range");
+    if (target && *target >= V) throw std::invalid_argument("target is out of range");
+    if (!this->coordinates.empty() && this->coordinates.size() != V) {
+        throw std::invalid_argument("coordinates must have one entry per node");
+    }
+    reverse = forward.reversed();
+
+    // A* stays exact as long as the estimate never exceeds an edge's weight,
+    // so the straight-line distance is scaled by the smallest weight per unit
+    if (this->coordinates.empty()) return;
+    scale = std::numeric_limits<double>::infinity();
+    for (uint32_t u = 0; u < V; ++u) {
+        for (uint32_t e = forward.offsets[u]; e < forward.offsets[u + 1]; ++e) {
+            const auto &a = this->coordinates[u];
+            const auto &b = this->coordinates[forward.targets[e]];
+            const double length = std::hypot(a.first - b.first, a.second - b.second);
+            if (length > 0) scale = std::min(scale, forward.weights[e] / length);
+        }
+    }
+    // Shaved a little so rounding in hypot cannot push an estimate past a weight
+    scale = std::isfinite(scale) ? scale * (1.0 - 1e-9) : 0.0;
+}
+
+double ComparisonInput::heuristic(uint32_t node) const {
+    if (scale == 0.0 || !to) return 0.0;
+    const auto &a = coordinates[node];
+    const auto &b = coordinates[*to];
+    return scale * std::hypot(a.first - b.first, a.second - b.second);
+}
+
+ComparisonResult runAlgorithm(Algorithm algorithm, const ComparisonInput &input) {
+    if ((algorithm == Algorithm::AStar || algorithm == Algorithm::Bidirectional) && !input.target()) {
+        throw std::invalid_argument(std::string(algorithmName(algorithm)) + " needs a target");
+    }
+    switch (algorithm) {
+        case Algorithm::Bfs:
+            return bfs(input);
+        case Algorithm::ArrayDijkstra:
+            return librarySearch<shortest_path::LinearScanQueue>(input, shortest_path::ZeroHeuristic<int64_t>{});
+        case Algorithm::HeapDijkstra:
+            return librarySearch<shortest_path::BinaryHeapQueue>(input, shortest_path::ZeroHeuristic<int64_t>{});
+        case Algorithm::AStar: {
+            // Rounded down, so the integer estimate is still a lower bound
+            const auto estimate = shortest_path::makeHeuristic<int64_t>([&input](uint32_t v) {
+                return std::floor(input.heuristic(v));
+            });
+            return librarySearch<shortest_path::BinaryHeapQueue>(input, estimate);
+        }
+        case Algorithm::Bidirectional:
+            return bidirectional(input);
+        case Algorithm::BellmanFord:
+            return bellmanFord(input);
+    }
+    throw std::invalid_argument("Unknown algorithm");
+}
@@ -0,0 +1,72 @@
+#ifndef COMPARE_HPP
+#define COMPARE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sparse.hpp"
+
+enum class Algorithm {
+    Bfs,            // hop counts, ignores weights
+    ArrayDijkstra,  // O(V^2), scans the distance array for the next node
+    HeapDijkstra,   // binary heap with lazy deletion
+    AStar,          // heap Dijkstra ordered by distance plus a straight-line bound
+    Bidirectional,  // Dijkstra from both ends until the frontiers prove the best meeting point
+    BellmanFord     // rounds over every edge until nothing changes
+};
+
+// Parse an algorithm name as used in requests, e.g. "heap_dijkstra"
+std::optional<Algorithm> parseAlgorithm(const std::string &name);
+const char *algorithmName(Algorithm algorithm);
+
+// Effort of one run. A node is settled when its distance is final, a
+// relaxation is one look at an edge, and heap operations count pushes and pops.
+struct SearchCounters {
+    uint64_t settled = 0;
+    uint64_t relaxations = 0;
+    uint64_t heapOperations = 0;
+};
+
+// What every algorithm of a comparison shares. Built once, outside the timed runs.
+class ComparisonInput {
+public:
+    /**
+     * @param coordinates Optional position of every node, used by A*
+     * @throws std::invalid_argument if source, target or the coordinates do not fit the graph
+     */
+    ComparisonInput(CsrGraph graph, uint32_t source, std::optional<uint32_t> target,
+                    std::vector<std::pair<double, double>> coordinates);
+
+    const CsrGraph &graph() const { return forward; }
+    const CsrGraph &reverseGraph() const { return reverse; }
+    uint32_t source() const { return from; }
+    const std::optional<uint32_t> &target() const { return to; }
+
+    // Lower bound on the distance from node to the target
+    double heuristic(uint32_t node) const;
+
+private:
+    CsrGraph forward;
+    CsrGraph reverse;
+    uint32_t from;
+    std::optional<uint32_t> to;
+    std::vector<std::pair<double, double>> coordinates;
+    double scale = 0.0;  // largest factor keeping the straight-line distance below every edge weight
+};
+
+struct ComparisonResult {
+    SearchCounters counters;
+    int64_t distance = UNREACHABLE;  // to the target, if there is one
+    uint64_t reached = 0;            // nodes with a finite distance
+};
+
+/**
+ * Run one algorithm once. With a target the searches that can stop early do;
+ * without one they compute every distance from the source.
+ * @throws std::invalid_argument for A* or bidirectional search without a target
+ */
+ComparisonResult runAlgorithm(Algorithm algorithm, const ComparisonInput &input);
+
+#endif // COMPARE_HPP
@@ -0,0 +1,55 @@
+#include "compute_pool.hpp"
+#include <stdexcept>
+#include <async_log/log.hpp>
+
+ComputePool::ComputePool(size_t threads, size_t queueCapacity, size_t byteBudget)
+    : capacity(queueCapacity), byteBudget(byteBudget) {
+    if (threads == 0) throw std::invalid_argument("A compute pool needs at least one thread");
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ComputePool::work, this);
+    }
+}
+
+ComputePool::~ComputePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+bool ComputePool::submit(std::function<void()> job, size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || queue.size() >= capacity || bytes > byteBudget - heldBytes) return false;
+        heldBytes += bytes;
+        queue.push_back({std::move(job), bytes});
+    }
+    ready.notify_one();
+    return true;
+}
+
+void ComputePool::work() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        // Handlers answer their own errors; anything escaping must not take the worker down
+        try {
+            job.run();
+        } catch (const std::exception& e) {
+            async_log::error("Compute job failed", {{"error", e.what()}});
+        }
+        // Destroyed first, so the bytes are really free when they return to the budget
+        job.run = nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        heldBytes -= job.bytes;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef COMPUTE_POOL_HPP
+#define COMPUTE_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads behind a bounded queue. Pistache's I/O threads
+// hand solver work here and return at once, so a large graph occupies a
+// compute thread instead of the event loop that serves every other client.
+// The queue is bounded both in jobs and in the bytes they hold, e.g. copied
+// request bodies, counted until each job has finished.
+class ComputePool {
+public:
+    ComputePool(size_t threads, size_t queueCapacity, size_t byteBudget);
+
+    // Runs the jobs still queued, then joins the workers
+    ~ComputePool();
+
+    ComputePool(const ComputePool&) = delete;
+    ComputePool& operator=(const ComputePool&) = delete;
+
+    /**
+     * Queue a job for the next free worker
+     * @param bytes Memory the job holds until it has run
+     * @return false, without running the job, if the queue is full or the
+     *         job's bytes do not fit in the budget
+     */
+    bool submit(std::function<void()> job, size_t bytes = 0);
+
+private:
+    struct Job {
+        std::function<void()> run;
+        size_t bytes;
+    };
+
+    size_t capacity;
+    size_t byteBudget;
+    size_t heldBytes = 0;  // of queued and running jobs
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Job> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work();
+};
+
+#endif // COMPUTE_POOL_HPP
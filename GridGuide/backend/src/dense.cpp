@@ -0,0 +1,274 @@
+#include "dense.hpp"
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <immintrin.h>
+
+// The binary cells are used in place, so they must already be in host order
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "binary matrices are read as little-endian");
+
+namespace {
+
+template <typename T>
+T readLittleEndian(const char* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof value);
+    return value;
+}
+
+void checkNodeCount(uint64_t V) {
+    if (V > DenseMatrix::MAX_NODES) {
+        throw std::invalid_argument("Dense graphs are limited to " + std::to_string(DenseMatrix::MAX_NODES) + " nodes");
+    }
+}
+
+int32_t checkedWeight(int32_t weight) {
+    if (weight < 0) throw std::invalid_argument("Edge weights must not be negative");
+    return weight;
+}
+
+// Keys are padded to whole AVX2 vectors with INT_MAX
+constexpr size_t LANES = 8;
+
+size_t paddedSize(size_t V) { return (V + LANES - 1) / LANES * LANES; }
+
+// Highest index holding the smallest key, or -1 if every key is INT_MAX
+int argminScalar(const int32_t* keys, size_t padded) {
+    int32_t best = INT_MAX;
+    int index = -1;
+    for (size_t i = 0; i < padded; ++i) {
+        if (keys[i] <= best && keys[i] != INT_MAX) {
+            best = keys[i];
+            index = static_cast<int>(i);
+        }
+    }
+    return index;
+}
+
+__attribute__((target("avx2")))
+int argminAvx2(const int32_t* keys, size_t padded) {
+    __m256i best = _mm256_set1_epi32(INT_MAX);
+    for (size_t i = 0; i < padded; i += LANES) {
+        best = _mm256_min_epi32(best, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+    }
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    const int32_t minimum = _mm_cvtsi128_si32(half);
+    if (minimum == INT_MAX) return -1;
+
+    // Second pass from the end for the highest index with that key
+    const __m256i target = _mm256_set1_epi32(minimum);
+    for (size_t i = padded; i > 0; i -= LANES) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i - LANES));
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, target)));
+        if (mask) return static_cast<int>(i - LANES) + 31 - __builtin_clz(mask);
+    }
+    return -1;
+}
+
+// Relax one cell: an edge (weight != 0) that shortens v without overflowing
+template <typename Cell>
+void relaxScalar(Cell weight, int v, int32_t du, int32_t* dist, int32_t* keys, std::vector<int>& relaxed) {
+    const int32_t candidate = static_cast<int32_t>(static_cast<uint32_t>(du) + static_cast<uint32_t>(weight));
+    if (weight != 0 && candidate >= du && candidate < dist[v]) {
+        dist[v] = candidate;
+        keys[v] = candidate;
+        relaxed.push_back(v);
+    }
+}
+
+template <typename Cell>
+void relaxRangeScalar(const Cell* weights, int first, int last, int32_t du, int32_t* dist, int32_t* keys,
+                      std::vector<int>& relaxed) {
+    for (int v = first; v < last; ++v) relaxScalar(weights[v - first], v, du, dist, keys, relaxed);
+}
+
+__attribute__((target("avx2")))
+inline __m256i loadWeights(const int32_t* weights) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights));
+}
+
+__attribute__((target("avx2")))
+inline __m256i loadWeights(const uint16_t* weights) {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights)));
+}
+
+// Settled nodes have dist <= du <= candidate, so the compare alone keeps them out
+template <typename Cell>
+__attribute__((target("avx2")))
+void relaxRangeAvx2(const Cell* weights, int first, int last, int32_t du, int32_t* dist, int32_t* keys,
+                    std::vector<int>& relaxed) {
+    const __m256i base = _mm256_set1_epi32(du);
+    const __m256i zero = _mm256_setzero_si256();
+    int v = first;
+    for (; v + static_cast<int>(LANES) <= last; v += LANES) {
+        const __m256i w = loadWeights(weights + (v - first));
+        const __m256i candidate = _mm256_add_epi32(base, w);
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dist + v));
+        // Shorter, an edge, and no wrap past INT_MAX
+        __m256i better = _mm256_cmpgt_epi32(current, candidate);
+        better = _mm256_andnot_si256(_mm256_cmpeq_epi32(w, zero), better);
+        better = _mm256_andnot_si256(_mm256_cmpgt_epi32(base, candidate), better);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(better));
+        if (!mask) continue;
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dist + v), _mm256_blendv_epi8(current, candidate, better));
+        const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + v), _mm256_blendv_epi8(key, candidate, better));
+        while (mask) {
+            relaxed.push_back(v + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    relaxRangeScalar(weights + (v - first), v, last, du, dist, keys, relaxed);
+}
+
+template <typename Cell, bool Packed, bool Avx2>
+void vectorDijkstraCells(const Cell* cells, int V, int src, std::vector<int>& distances, const SettleVisitor& visit) {
+    distances.assign(V, INT_MAX);
+    std::vector<int32_t> keys(paddedSize(V), INT_MAX);
+    int32_t* dist = distances.data();
+    std::vector<int> relaxed;
+    dist[src] = 0;
+    keys[src] = 0;
+
+    // Unreachable nodes are settled last, from the highest index down
+    int unreachable = V - 1;
+
+    for (int count = 0; count < V - 1; count++) {
+        int u;
+        if constexpr (Avx2) {
+            u = argminAvx2(keys.data(), keys.size());
+        } else {
+            u = argminScalar(keys.data(), keys.size());
+        }
+        relaxed.clear();
+        if (u < 0) {
+            while (dist[unreachable] != INT_MAX) --unreachable;
+            u = unreachable--;
+            visit(u, relaxed);
+            continue;
+        }
+        keys[u] = INT_MAX;
+        const int32_t du = dist[u];
+
+        if constexpr (Packed) {
+            // (v, u) for v < u sits in column u, one shrinking row apart
+            size_t column = u - 1;
+            for (int v = 0; v < u; ++v) {
+                relaxScalar(cells[column], v, du, dist, keys.data(), relaxed);
+                column += V - v - 2;
+            }
+            const Cell* row = cells + DenseMatrix::triangleRow(V, u);
+            if constexpr (Avx2) {
+                relaxRangeAvx2(row, u + 1, V, du, dist, keys.data(), relaxed);
+            } else {
+                relaxRangeScalar(row, u + 1, V, du, dist, keys.data(), relaxed);
+            }
+        } else {
+            const Cell* row = cells + static_cast<size_t>(u) * V;
+            if constexpr (Avx2) {
+                relaxRangeAvx2(row, 0, V, du, dist, keys.data(), relaxed);
+            } else {
+                relaxRangeScalar(row, 0, V, du, dist, keys.data(), relaxed);
+            }
+        }
+        visit(u, relaxed);
+    }
+}
+
+} // namespace
+
+DenseMatrix DenseMatrix::fromJson(const json& body) {
+    DenseMatrix matrix;
+    if (body.is_object()) {
+        const json& triangle = body.at("upper_triangle");
+        matrix.V = body.at("nodes").get<size_t>();
+        checkNodeCount(matrix.V);
+        matrix.cellLayout = MatrixLayout::UpperTriangle;
+        const size_t count = cellCount(matrix.V, matrix.cellLayout);
+        if (!triangle.is_array() || triangle.size() != count) {
+            throw std::invalid_argument("upper_triangle of " + std::to_string(matrix.V) + " nodes must have " +
+                                        std::to_string(count) + " entries");
+        }
+        matrix.owned.reserve(count);
+        for (const auto& cell : triangle) matrix.owned.push_back(checkedWeight(cell.get<int32_t>()));
+        matrix.cells = matrix.owned.data();
+        return matrix;
+    }
+
+    matrix.V = body.size();
+    checkNodeCount(matrix.V);
+    matrix.owned.reserve(matrix.V * matrix.V);
+    for (const auto& row : body) {
+        if (!row.is_array() || row.size() != matrix.V) throw std::invalid_argument("matrix must be square");
+        for (const auto& cell : row) matrix.owned.push_back(checkedWeight(cell.get<int32_t>()));
+    }
+    matrix.cells = matrix.owned.data();
+    return matrix;
+}
+
+DenseMatrix DenseMatrix::fromBinary(const std::string& body) {
+    if (body.size() < HEADER_BYTES) throw std::invalid_argument("Binary matrix is missing its header");
+
+    DenseMatrix matrix;
+    matrix.V = readLittleEndian<uint32_t>(body.data());
+    matrix.width = readLittleEndian<uint16_t>(body.data() + 4);
+    const uint16_t layout = readLittleEndian<uint16_t>(body.data() + 6);
+    if (matrix.width != 2 && matrix.width != 4) {
+        throw std::invalid_argument("Element width must be 2 (uint16) or 4 (int32)");
+    }
+    if (layout != static_cast<uint16_t>(MatrixLayout::Full) &&
+        layout != static_cast<uint16_t>(MatrixLayout::UpperTriangle)) {
+        throw std::invalid_argument("Layout must be 0 (full) or 1 (upper triangle)");
+    }
+    matrix.cellLayout = static_cast<MatrixLayout>(layout);
+    checkNodeCount(matrix.V);
+    const size_t count = cellCount(matrix.V, matrix.cellLayout);
+    const size_t expected = HEADER_BYTES + count * matrix.width;
+    if (body.size() != expected) {
+        throw std::invalid_argument("Binary matrix of " + std::to_string(matrix.V) + " nodes must be " +
+                                    std::to_string(expected) + " bytes");
+    }
+
+    const char* first = body.data() + HEADER_BYTES;
+    if (matrix.width == 4) {
+        for (size_t i = 0; i < count; ++i) checkedWeight(readLittleEndian<int32_t>(first + 4 * i));
+    }
+    if (reinterpret_cast<uintptr_t>(first) % matrix.width == 0) {
+        matrix.cells = first;
+        return matrix;
+    }
+    // Only a body buffer that is not word aligned gets here; widen into an owned copy
+    matrix.owned.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (matrix.width == 2) {
+            matrix.owned[i] = readLittleEndian<uint16_t>(first + 2 * i);
+        } else {
+            matrix.owned[i] = readLittleEndian<int32_t>(first + 4 * i);
+        }
+    }
+    matrix.width = 4;
+    matrix.cells = matrix.owned.data();
+    return matrix;
+}
+
+bool avx2Available() {
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+}
+
+void vectorDijkstra(const DenseMatrix& graph, int src, std::vector<int>& distances, const SettleVisitor& visit) {
+    const bool avx2 = avx2Available();
+    graph.visit([&](const auto* cells, auto packed) {
+        using Cell = std::remove_const_t<std::remove_pointer_t<decltype(cells)>>;
+        constexpr bool Packed = decltype(packed)::value;
+        const int V = static_cast<int>(graph.size());
+        if (avx2) {
+            vectorDijkstraCells<Cell, Packed, true>(cells, V, src, distances, visit);
+        } else {
+            vectorDijkstraCells<Cell, Packed, false>(cells, V, src, distances, visit);
+        }
+    });
+}
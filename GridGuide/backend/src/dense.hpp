@@ -0,0 +1,110 @@
+#ifndef DENSE_HPP
+#define DENSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// How the cells of a DenseMatrix are laid out
+enum class MatrixLayout : uint16_t {
+    Full = 0,          // V * V cells, row by row
+    UpperTriangle = 1  // undirected: the V * (V - 1) / 2 cells right of the diagonal, row by row
+};
+
+// Square weight matrix in one flat buffer; 0 means no edge.
+//
+// The binary form (application/octet-stream) is little-endian:
+//   u32 V, u16 element width in bytes (2 or 4), u16 layout (MatrixLayout),
+//   then the cells, uint16 for width 2 and int32 for width 4
+// Its cells are read in place from the request body, which therefore has to
+// outlive the matrix. JSON is parsed into a buffer the matrix owns.
+class DenseMatrix {
+public:
+    // Size of the binary header
+    static constexpr size_t HEADER_BYTES = 8;
+    // Largest matrix accepted, 64 MiB of int32 cells
+    static constexpr uint32_t MAX_NODES = 4096;
+
+    /**
+     * Parse a JSON array of V rows of V integers each, or an undirected graph
+     * as {"nodes": V, "upper_triangle": [w01, w02, ..., w0(V-1), w12, ...]}
+     * @throws std::invalid_argument if the rows are not square, the triangle has the wrong length
+     *         or a weight is negative
+     */
+    static DenseMatrix fromJson(const json& body);
+
+    /**
+     * View a binary body without copying its cells
+     * @throws std::invalid_argument for a bad header, a body of the wrong size or a negative weight
+     */
+    static DenseMatrix fromBinary(const std::string& body);
+
+    DenseMatrix(DenseMatrix&&) = default;
+    DenseMatrix& operator=(DenseMatrix&&) = default;
+    DenseMatrix(const DenseMatrix&) = delete;
+    DenseMatrix& operator=(const DenseMatrix&) = delete;
+
+    size_t size() const { return V; }
+    MatrixLayout layout() const { return cellLayout; }
+
+    // Number of cells a matrix of V nodes stores in a layout
+    static size_t cellCount(size_t V, MatrixLayout layout) {
+        return layout == MatrixLayout::UpperTriangle ? V * (V - (V > 0)) / 2 : V * V;
+    }
+
+    // Position of row u's first cell in the upper triangle, which is the cell (u, u + 1)
+    static size_t triangleRow(size_t V, size_t u) { return u * V - u * (u + 1) / 2; }
+
+    // Call f(cells, packed) with a pointer to the first cell typed by the element
+    // width, and std::true_type for the upper triangle or std::false_type otherwise
+    template <typename F>
+    void visit(F&& f) const {
+        if (cellLayout == MatrixLayout::UpperTriangle) {
+            visitCells(f, std::true_type{});
+        } else {
+            visitCells(f, std::false_type{});
+        }
+    }
+
+private:
+    DenseMatrix() = default;
+
+    template <typename F, typename Packed>
+    void visitCells(F& f, Packed packed) const {
+        if (width == 2) {
+            f(static_cast<const uint16_t*>(cells), packed);
+        } else {
+            f(static_cast<const int32_t*>(cells), packed);
+        }
+    }
+
+    size_t V = 0;
+    uint32_t width = 4;
+    MatrixLayout cellLayout = MatrixLayout::Full;
+    const void* cells = nullptr;  // owned.data() or a view into a request body
+    std::vector<int32_t> owned;
+};
+
+// Receives each node the vector kernel settles, with the nodes whose distance it lowered
+using SettleVisitor = std::function<void(int u, const std::vector<int>& relaxed)>;
+
+// Whether this CPU runs the AVX2 paths of vectorDijkstra
+bool avx2Available();
+
+/**
+ * O(V^2) Dijkstra for dense graphs without a visited array: settled nodes are
+ * folded into a key array as INT_MAX, so picking the next node is one min-scan
+ * and relaxing a row is a min and compare per cell. Both run eight lanes at a
+ * time with AVX2, or as plain loops on CPUs without it. Settles nodes in the
+ * same order as the classic kernel (ties go to the highest index), V - 1 of them.
+ * @param distances Receives the distances, INT_MAX for unreachable nodes; up to date at each visit
+ */
+void vectorDijkstra(const DenseMatrix& graph, int src, std::vector<int>& distances, const SettleVisitor& visit);
+
+#endif // DENSE_HPP
@@ -0,0 +1,449 @@
+#include "grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+// Largest grid accepted, 2048 x 2048 cells or any other shape of that area
+constexpr int64_t MAX_CELLS = int64_t{1} << 22;
+
+constexpr double SQRT2 = 1.4142135623730951;
+
+BitGrid::Lines emptyLines(int count, int length) {
+    BitGrid::Lines lines;
+    lines.count = count;
+    lines.length = length;
+    lines.words = (length + 63) / 64;
+    lines.bits.assign(static_cast<size_t>(count + 2) * lines.words, 0);
+    return lines;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    throw std::invalid_argument(std::string("Invalid hex digit '") + c + "' in grid row");
+}
+
+int countTrailingZeros(uint64_t word) { return __builtin_ctzll(word); }
+int highestBit(uint64_t word) { return 63 - __builtin_clzll(word); }
+
+// First jump point after pos along line i moving dir (+1 or -1): the goal, or
+// a free cell whose neighbour on line i - 1 or i + 1 is free while the cell
+// behind that neighbour is not. Returns -1 if a wall comes first.
+int scanLine(const BitGrid::Lines &lines, int i, int pos, int dir, int goalPos) {
+    const uint64_t *cur = lines.line(i);
+    const uint64_t *above = lines.line(i - 1);
+    const uint64_t *below = lines.line(i + 1);
+    const int words = lines.words;
+
+    if (dir > 0) {
+        const int first = pos + 1;
+        for (int w = first >> 6; w < words; ++w) {
+            // Bit f of behind* is the neighbour line at f - 1
+            const uint64_t behindAbove = (above[w] << 1) | (w > 0 ? above[w - 1] >> 63 : 0);
+            const uint64_t behindBelow = (below[w] << 1) | (w > 0 ? below[w - 1] >> 63 : 0);
+            uint64_t events = ~cur[w] | (above[w] & ~behindAbove) | (below[w] & ~behindBelow);
+            if (goalPos >= 0 && (goalPos >> 6) == w) events |= uint64_t{1} << (goalPos & 63);
+            if (w == first >> 6) events &= ~uint64_t{0} << (first & 63);
+            if (events) {
+                const int bit = countTrailingZeros(events);
+                return (cur[w] >> bit) & 1 ? (w << 6) + bit : -1;
+            }
+        }
+    } else {
+        const int first = pos - 1;
+        for (int w = first >> 6; w >= 0 && first >= 0; --w) {
+            // Bit f of behind* is the neighbour line at f + 1
+            const uint64_t behindAbove = (above[w] >> 1) | (w + 1 < words ? above[w + 1] << 63 : 0);
+            const uint64_t behindBelow = (below[w] >> 1) | (w + 1 < words ? below[w + 1] << 63 : 0);
+            uint64_t events = ~cur[w] | (above[w] & ~behindAbove) | (below[w] & ~behindBelow);
+            if (goalPos >= 0 && (goalPos >> 6) == w) events |= uint64_t{1} << (goalPos & 63);
+            if (w == first >> 6) events &= ~uint64_t{0} >> (63 - (first & 63));
+            if (events) {
+                const int bit = highestBit(events);
+                return (cur[w] >> bit) & 1 ? (w << 6) + bit : -1;
+            }
+        }
+    }
+    return -1;
+}
+
+class JumpPointSearch {
+public:
+    JumpPointSearch(const BitGrid &grid, Cell goal, Connectivity connectivity)
+        : grid(grid), goal(goal), eight(connectivity == Connectivity::Eight) {}
+
+    // Jump point reached from (x, y) moving (dx, dy), if any
+    bool jump(int x, int y, int dx, int dy, Cell &found) const {
+        if (dy == 0) {
+            const int jx = scanRow(x, y, dx);
+            if (jx < 0) return false;
+            found = {jx, y};
+            return true;
+        }
+        if (dx == 0 && eight) {
+            const int jy = scanColumn(x, y, dy);
+            if (jy < 0) return false;
+            found = {x, jy};
+            return true;
+        }
+        if (dx == 0) return jumpVertical4(x, y, dy, found);
+        return jumpDiagonal(x, y, dx, dy, found);
+    }
+
+    // Directions worth jumping in from (x, y), reached from its parent moving (dx, dy)
+    void successors(int x, int y, int dx, int dy, std::vector<Cell> &directions) const {
+        directions.clear();
+        auto open = [&](int ox, int oy) { return grid.free(x + ox, y + oy); };
+        if (dx == 0 && dy == 0) {
+            for (const Cell &d : {Cell{1, 0}, Cell{-1, 0}, Cell{0, 1}, Cell{0, -1}}) {
+                if (open(d.first, d.second)) directions.push_back(d);
+            }
+            if (eight) {
+                for (const Cell &d : {Cell{1, 1}, Cell{1, -1}, Cell{-1, 1}, Cell{-1, -1}}) {
+                    if (open(d.first, 0) && open(0, d.second) && open(d.first, d.second)) directions.push_back(d);
+                }
+            }
+            return;
+        }
+        if (!eight) {
+            // The way on, plus both turns; the jumps prune what is not a jump point
+            if (dx != 0) {
+                for (const Cell &d : {Cell{dx, 0}, Cell{0, 1}, Cell{0, -1}}) {
+                    if (open(d.first, d.second)) directions.push_back(d);
+                }
+            } else {
+                for (const Cell &d : {Cell{0, dy}, Cell{1, 0}, Cell{-1, 0}}) {
+                    if (open(d.first, d.second)) directions.push_back(d);
+                }
+            }
+            return;
+        }
+        if (dx != 0 && dy != 0) {
+            const bool along = open(dx, 0);
+            const bool across = open(0, dy);
+            if (across) directions.push_back({0, dy});
+            if (along) directions.push_back({dx, 0});
+            if (along && across && open(dx, dy)) directions.push_back({dx, dy});
+        } else if (dx != 0) {
+            const bool next = open(dx, 0);
+            const bool up = open(0, -1);
+            const bool down = open(0, 1);
+            if (next) {
+                directions.push_back({dx, 0});
+                if (up && open(dx, -1)) directions.push_back({dx, -1});
+                if (down && open(dx, 1)) directions.push_back({dx, 1});
+            }
+            if (up) directions.push_back({0, -1});
+            if (down) directions.push_back({0, 1});
+        } else {
+            const bool next = open(0, dy);
+            const bool left = open(-1, 0);
+            const bool right = open(1, 0);
+            if (next) {
+                directions.push_back({0, dy});
+                if (left && open(-1, dy)) directions.push_back({-1, dy});
+                if (right && open(1, dy)) directions.push_back({1, dy});
+            }
+            if (left) directions.push_back({-1, 0});
+            if (right) directions.push_back({1, 0});
+        }
+    }
+
+    // Exact cost between two cells on a common line, or the admissible estimate otherwise
+    double distance(Cell a, Cell b) const {
+        const int ax = std::abs(a.first - b.first);
+        const int ay = std::abs(a.second - b.second);
+        if (!eight) return ax + ay;
+        return std::max(ax, ay) - std::min(ax, ay) + SQRT2 * std::min(ax, ay);
+    }
+
+private:
+    const BitGrid &grid;
+    Cell goal;
+    bool eight;
+
+    int scanRow(int x, int y, int dx) const {
+        return scanLine(grid.rowLines(), y, x, dx, goal.second == y ? goal.first : -1);
+    }
+
+    int scanColumn(int x, int y, int dy) const {
+        return scanLine(grid.columnLines(), x, y, dy, goal.first == x ? goal.second : -1);
+    }
+
+    // Vertical moves are where a 4-connected path turns, so they check the row at every step
+    bool jumpVertical4(int x, int y, int dy, Cell &found) const {
+        while (grid.free(x, y + dy)) {
+            y += dy;
+            const bool forced = (grid.free(x - 1, y) && !grid.free(x - 1, y - dy)) ||
+                                (grid.free(x + 1, y) && !grid.free(x + 1, y - dy));
+            if (Cell{x, y} == goal || forced || scanRow(x, y, 1) >= 0 || scanRow(x, y, -1) >= 0) {
+                found = {x, y};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool jumpDiagonal(int x, int y, int dx, int dy, Cell &found) const {
+        while (grid.free(x + dx, y) && grid.free(x, y + dy) && grid.free(x + dx, y + dy)) {
+            x += dx;
+            y += dy;
+            if (Cell{x, y} == goal || scanRow(x, y, dx) >= 0 || scanColumn(x, y, dy) >= 0) {
+                found = {x, y};
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+bool validCell(const BitGrid &grid, Cell cell) {
+    return grid.free(cell.first, cell.second);
+}
+
+// Multi-word shifts of a line by one cell towards higher or lower positions
+void shiftUp(const uint64_t *src, uint64_t *dst, int words) {
+    for (int w = words - 1; w >= 0; --w) dst[w] = (src[w] << 1) | (w > 0 ? src[w - 1] >> 63 : 0);
+}
+
+void shiftDown(const uint64_t *src, uint64_t *dst, int words) {
+    for (int w = 0; w < words; ++w) dst[w] = (src[w] >> 1) | (w + 1 < words ? src[w + 1] << 63 : 0);
+}
+
+} // namespace
+
+BitGrid::BitGrid(int width, int height, const std::vector<std::string> &hexRows) {
+    if (width <= 0 || height <= 0 || static_cast<int64_t>(width) * height > MAX_CELLS) {
+        throw std::invalid_argument("Grid must have between 1 and " + std::to_string(MAX_CELLS) + " cells");
+    }
+    if (hexRows.size() != static_cast<size_t>(height)) {
+        throw std::invalid_argument("Expected " + std::to_string(height) + " rows");
+    }
+    const size_t digits = (width + 3) / 4;
+    rows = emptyLines(height, width);
+    columns = emptyLines(width, height);
+
+    for (int y = 0; y < height; ++y) {
+        const std::string &hex = hexRows[y];
+        if (hex.size() != digits) {
+            throw std::invalid_argument("Row " + std::to_string(y) + " must have " + std::to_string(digits) +
+                                        " hex digits");
+        }
+        uint64_t *row = rows.line(y);
+        for (int x = 0; x < width; ++x) {
+            const bool wall = (hexDigit(hex[x >> 2]) >> (3 - (x & 3))) & 1;
+            if (wall) continue;
+            row[x >> 6] |= uint64_t{1} << (x & 63);
+            columns.line(x)[y >> 6] |= uint64_t{1} << (y & 63);
+        }
+    }
+}
+
+GridSearchResult jumpPointSearch(const BitGrid &grid, Cell start, Cell goal, Connectivity connectivity,
+                                 bool recordExpanded) {
+    GridSearchResult result;
+    if (!validCell(grid, start) || !validCell(grid, goal)) {
+        throw std::invalid_argument("start and goal must be free cells inside the grid");
+    }
+
+    const int width = grid.width();
+    const size_t cells = static_cast<size_t>(width) * grid.height();
+    auto index = [width](Cell c) { return static_cast<size_t>(c.second) * width + c.first; };
+    auto cellAt = [width](size_t i) { return Cell{static_cast<int>(i % width), static_cast<int>(i / width)}; };
+
+    JumpPointSearch search(grid, goal, connectivity);
+    std::vector<double> gScore(cells, std::numeric_limits<double>::infinity());
+    std::vector<uint32_t> parent(cells, std::numeric_limits<uint32_t>::max());
+    std::vector<bool> closed(cells, false);
+
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    gScore[index(start)] = 0.0;
+    open.push({search.distance(start, goal), static_cast<uint32_t>(index(start))});
+
+    std::vector<Cell> directions;
+    bool reached = false;
+    while (!open.empty()) {
+        const uint32_t current = open.top().second;
+        open.pop();
+        // Stale entry left behind by a later improvement
+        if (closed[current]) continue;
+        closed[current] = true;
+
+        const Cell cell = cellAt(current);
+        if (recordExpanded) result.expanded.push_back(cell);
+        if (cell == goal) {
+            reached = true;
+            break;
+        }
+
+        int dx = 0, dy = 0;
+        if (parent[current] != std::numeric_limits<uint32_t>::max()) {
+            const Cell from = cellAt(parent[current]);
+            dx = sign(cell.first - from.first);
+            dy = sign(cell.second - from.second);
+        }
+        search.successors(cell.first, cell.second, dx, dy, directions);
+
+        for (const Cell &d : directions) {
+            Cell next;
+            if (!search.jump(cell.first, cell.second, d.first, d.second, next)) continue;
+            const uint32_t n = static_cast<uint32_t>(index(next));
+            if (closed[n]) continue;
+            const double candidate = gScore[current] + search.distance(cell, next);
+            if (candidate < gScore[n]) {
+                gScore[n] = candidate;
+                parent[n] = current;
+                open.push({candidate + search.distance(next, goal), n});
+            }
+        }
+    }
+
+    if (!reached) return result;
+    result.cost = gScore[index(goal)];
+
+    // Walk back over the jump points, filling in the straight or diagonal runs between them
+    std::vector<Cell> jumpPoints;
+    for (uint32_t i = static_cast<uint32_t>(index(goal)); i != std::numeric_limits<uint32_t>::max(); i = parent[i]) {
+        jumpPoints.push_back(cellAt(i));
+    }
+    std::reverse(jumpPoints.begin(), jumpPoints.end());
+    result.path.push_back(jumpPoints.front());
+    for (size_t k = 1; k < jumpPoints.size(); ++k) {
+        Cell c = jumpPoints[k - 1];
+        const int dx = sign(jumpPoints[k].first - c.first);
+        const int dy = sign(jumpPoints[k].second - c.second);
+        while (c != jumpPoints[k]) {
+            c.first += dx;
+            c.second += dy;
+            result.path.push_back(c);
+        }
+    }
+    return result;
+}
+
+GridSearchResult bitParallelBfs(const BitGrid &grid, Cell start, Cell goal, Connectivity connectivity,
+                                bool recordExpanded) {
+    GridSearchResult result;
+    if (!validCell(grid, start) || !validCell(grid, goal)) {
+        throw std::invalid_argument("start and goal must be free cells inside the grid");
+    }
+
+    const BitGrid::Lines &free = grid.rowLines();
+    const int width = grid.width();
+    const int height = grid.height();
+    const int words = free.words;
+    const bool eight = connectivity == Connectivity::Eight;
+
+    // Same layout as the grid rows, sentinel rows included, so row -1 and row height read empty
+    BitGrid::Lines frontier = emptyLines(height, width);
+    BitGrid::Lines next = emptyLines(height, width);
+    BitGrid::Lines visited = emptyLines(height, width);
+    std::vector<uint64_t> shifted(words), moved(words), candidates(words);
+
+    constexpr uint32_t UNSEEN = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> layer(static_cast<size_t>(width) * height, UNSEEN);
+    auto index = [width](int x, int y) { return static_cast<size_t>(y) * width + x; };
+
+    frontier.line(start.second)[start.first >> 6] |= uint64_t{1} << (start.first & 63);
+    visited.line(start.second)[start.first >> 6] |= uint64_t{1} << (start.first & 63);
+    layer[index(start.first, start.second)] = 0;
+    if (recordExpanded) result.expanded.push_back(start);
+
+    int low = start.second, high = start.second;
+    uint32_t depth = 0;
+    bool reached = start == goal;
+
+    while (!reached && low <= high) {
+        ++depth;
+        const int from = std::max(low - 1, 0);
+        const int to = std::min(high + 1, height - 1);
+        int nextLow = height, nextHigh = -1;
+
+        for (int y = from; y <= to; ++y) {
+            const uint64_t *here = frontier.line(y);
+            const uint64_t *open = free.line(y);
+            std::fill(candidates.begin(), candidates.end(), 0);
+
+            // Along the row, then straight in from the rows above and below
+            shiftUp(here, shifted.data(), words);
+            shiftDown(here, moved.data(), words);
+            for (int w = 0; w < words; ++w) candidates[w] = shifted[w] | moved[w];
+            for (int source : {y - 1, y + 1}) {
+                const uint64_t *other = frontier.line(source);
+                for (int w = 0; w < words; ++w) candidates[w] |= other[w];
+
+                if (!eight) continue;
+                // Diagonal from column x on the source row to x + 1 or x - 1 here, which
+                // needs (x, y) here and the cell beside x on the source row to be free
+                const uint64_t *otherOpen = free.line(source);
+                shiftDown(otherOpen, shifted.data(), words);  // bit x: source row at x + 1
+                for (int w = 0; w < words; ++w) moved[w] = other[w] & open[w] & shifted[w];
+                shiftUp(moved.data(), shifted.data(), words);
+                for (int w = 0; w < words; ++w) candidates[w] |= shifted[w];
+
+                shiftUp(otherOpen, shifted.data(), words);  // bit x: source row at x - 1
+                for (int w = 0; w < words; ++w) moved[w] = other[w] & open[w] & shifted[w];
+                shiftDown(moved.data(), shifted.data(), words);
+                for (int w = 0; w < words; ++w) candidates[w] |= shifted[w];
+            }
+
+            uint64_t *reachedRow = next.line(y);
+            uint64_t *seen = visited.line(y);
+            bool any = false;
+            for (int w = 0; w < words; ++w) {
+                uint64_t fresh = candidates[w] & open[w] & ~seen[w];
+                reachedRow[w] = fresh;
+                if (!fresh) continue;
+                any = true;
+                seen[w] |= fresh;
+                while (fresh) {
+                    const int x = (w << 6) + countTrailingZeros(fresh);
+                    fresh &= fresh - 1;
+                    layer[index(x, y)] = depth;
+                    if (recordExpanded) result.expanded.push_back({x, y});
+                }
+            }
+            if (any) {
+                nextLow = std::min(nextLow, y);
+                nextHigh = std::max(nextHigh, y);
+            }
+        }
+
+        for (int y = from; y <= to; ++y) std::fill(frontier.line(y), frontier.line(y) + words, 0);
+        std::swap(frontier, next);
+        low = nextLow;
+        high = nextHigh;
+        reached = layer[index(goal.first, goal.second)] != UNSEEN;
+    }
+
+    if (!reached) return result;
+
+    // Walk back from the goal through any neighbour one layer closer to the start
+    std::vector<Cell> steps = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}};
+    if (eight) steps.insert(steps.end(), {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}});
+    Cell cell = goal;
+    result.path.push_back(cell);
+    for (uint32_t d = layer[index(goal.first, goal.second)]; d > 0; --d) {
+        for (const Cell &s : steps) {
+            const int px = cell.first + s.first;
+            const int py = cell.second + s.second;
+            if (!grid.free(px, py) || layer[index(px, py)] != d - 1) continue;
+            if (s.first != 0 && s.second != 0 && !(grid.free(px, cell.second) && grid.free(cell.first, py))) continue;
+            cell = {px, py};
+            break;
+        }
+        result.path.push_back(cell);
+    }
+    std::reverse(result.path.begin(), result.path.end());
+    result.cost = static_cast<double>(result.path.size() - 1);
+    return result;
+}
@@ -0,0 +1,74 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Cell = std::pair<int, int>;  // x, y
+
+// Walkability of a grid packed 64 cells per word. The transpose is kept as
+// well, so scans along columns are word operations just like scans along
+// rows. Lines outside the grid and bits past its end read as walls.
+class BitGrid {
+public:
+    /**
+     * @param rows One hex string per row, four cells per digit, most significant
+     *             bit first (the string reads like the row); a set bit is a wall
+     * @throws std::invalid_argument for bad sizes, row lengths or digits
+     */
+    BitGrid(int width, int height, const std::vector<std::string> &rows);
+
+    int width() const { return rows.length; }
+    int height() const { return columns.length; }
+    bool free(int x, int y) const { return rows.test(y, x); }
+
+    // Packed lines; line -1 and line count are all-wall sentinels
+    struct Lines {
+        int count = 0;   // number of lines
+        int length = 0;  // cells per line
+        int words = 0;   // words per line
+        std::vector<uint64_t> bits;
+
+        const uint64_t *line(int i) const { return bits.data() + static_cast<size_t>(i + 1) * words; }
+        uint64_t *line(int i) { return bits.data() + static_cast<size_t>(i + 1) * words; }
+        bool test(int i, int pos) const {
+            if (i < -1 || i > count || pos < 0 || pos >= length) return false;
+            return (line(i)[pos >> 6] >> (pos & 63)) & 1;
+        }
+    };
+
+    const Lines &rowLines() const { return rows; }
+    const Lines &columnLines() const { return columns; }
+
+private:
+    Lines rows;     // line y, position x
+    Lines columns;  // line x, position y
+};
+
+enum class Connectivity { Four = 4, Eight = 8 };
+
+struct GridSearchResult {
+    std::vector<Cell> path;      // every cell from start to goal, empty if unreachable
+    double cost = 0.0;
+    std::vector<Cell> expanded;  // cells in the order the search expanded them
+};
+
+/**
+ * Jump Point Search on a uniform-cost grid. Diagonal steps cost sqrt(2) and
+ * may not cut corners. Straight jumps are bit scans over whole words.
+ * @param recordExpanded Fill result.expanded with the jump points in expansion order
+ */
+GridSearchResult jumpPointSearch(const BitGrid &grid, Cell start, Cell goal, Connectivity connectivity,
+                                 bool recordExpanded);
+
+/**
+ * Breadth-first search that advances the whole frontier a row of words at a
+ * time; every step costs 1, diagonal steps may not cut corners
+ * @param recordExpanded Fill result.expanded with the reached cells, layer by layer
+ */
+GridSearchResult bitParallelBfs(const BitGrid &grid, Cell start, Cell goal, Connectivity connectivity,
+                                bool recordExpanded);
+
+#endif // GRID_HPP
@@ -1,58 +1,100 @@
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <vector>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
 #include <pistache/endpoint.h>
 #include <pistache/http.h>
 #include <pistache/router.h>
 #include <nlohmann/json.hpp>
+#include <async_log/log.hpp>
+#include <shortest_path/layouts.hpp>
+#include <shortest_path/textbook.hpp>
+#include "compare.hpp"
+#include "compute_pool.hpp"
+#include "dense.hpp"
+#include "grid.hpp"
+#include "sparse.hpp"
 
 using namespace Pistache;
 using json = nlohmann::json;
 
-// Utility function to find the vertex with minimum distance value
-int minDistance(const std::vector<int> &dist, const std::vector<bool> &sptSet, int V) {
-    int min = std::numeric_limits<int>::max(), min_index = -1;
-    for (int v = 0; v < V; v++) {
-        if (!sptSet[v] && dist[v] <= min) {
-            min = dist[v];
-            min_index = v;
-        }
-    }
-    return min_index;
-}
+// Shape of the per-iteration log
+enum class TraceFormat {
+    Full,     // V-length "neighbors" and "updated_distances" arrays per iteration
+    Compact   // only the [node, distance] pairs an iteration changed, as "updates"
+};
 
-// Dijkstra's algorithm with JSON logging
-void dijkstra(const std::vector<std::vector<int>> &graph, int src, std::vector<int> &distances, json &iterations) {
-    int V = graph.size();
-    distances.assign(V, std::numeric_limits<int>::max());
-    std::vector<bool> sptSet(V, false);
+// Parse the optional ?trace= query parameter
+std::optional<TraceFormat> parseTraceFormat(const Rest::Request& request) {
+    const auto trace = request.query().get("trace");
+    if (!trace) return std::nullopt;
+    if (*trace == "full") return TraceFormat::Full;
+    if (*trace == "compact") return TraceFormat::Compact;
+    throw std::invalid_argument("trace must be \"full\" or \"compact\"");
+}
 
-    distances[src] = 0;
+// One iteration of the log: the node settled and the nodes whose distance it lowered
+template <typename Relaxed>
+json iterationRecord(int u, const Relaxed &relaxed, const std::vector<int> &distances, TraceFormat format) {
+    json iteration;
+    iteration["current_node"] = u;
+    if (format == TraceFormat::Compact) {
+        json updates = json::array();
+        for (int v : relaxed) updates.push_back({v, distances[v]});
+        iteration["updates"] = std::move(updates);
+    } else {
+        std::vector<int> neighbors(distances.size(), 0);
+        for (int v : relaxed) neighbors[v] = 1;
+        iteration["neighbors"] = std::move(neighbors);
+        iteration["updated_distances"] = distances;
+    }
+    return iteration;
+}
 
-    for (int count = 0; count < V - 1; count++) {
-        int u = minDistance(distances, sptSet, V);
-        sptSet[u] = true;
+// Dijkstra's algorithm with JSON logging, the shared library's textbook loop
+// over whichever cell type and layout the matrix holds
+void dijkstra(const DenseMatrix &graph, int src, std::vector<int> &distances,
+              const IterationSink &emit, TraceFormat format = TraceFormat::Full) {
+    auto log = [&](uint32_t u, const std::vector<uint32_t> &relaxed) {
+        emit(iterationRecord(static_cast<int>(u), relaxed, distances, format));
+    };
+    graph.visit([&](const auto *cells, auto packed) {
+        using Cell = std::remove_const_t<std::remove_pointer_t<decltype(cells)>>;
+        if constexpr (decltype(packed)::value) {
+            const shortest_path::UpperTriangleLayout<Cell> layout(cells, graph.size());
+            shortest_path::textbookDijkstra(layout, static_cast<uint32_t>(src), distances, log);
+        } else {
+            const shortest_path::DenseLayout<Cell> layout(cells, graph.size());
+            shortest_path::textbookDijkstra(layout, static_cast<uint32_t>(src), distances, log);
+        }
+    });
+}
 
-        json iteration;
-        iteration["current_node"] = u;
-        json neighbors = json::array();
-        json updated_distances = json::array();
+// Which dense Dijkstra solves a matrix
+enum class DenseKernel {
+    Scalar,  // dijkstra() above, the shared textbook loop with a branch per cell
+    Simd     // vectorDijkstra(), visited folded into the keys, AVX2 where the CPU has it
+};
 
-        for (int v = 0; v < V; v++) {
-            if (!sptSet[v] && graph[u][v] && distances[u] != std::numeric_limits<int>::max()
-                && distances[u] + graph[u][v] < distances[v]) {
-                distances[v] = distances[u] + graph[u][v];
-                neighbors.push_back(1);
-            } else {
-                neighbors.push_back(0);
-            }
-            updated_distances.push_back(distances[v]);
-        }
+// Parse the optional ?kernel= query parameter, "simd" unless "scalar" is asked for
+DenseKernel parseDenseKernel(const Rest::Request& request) {
+    const auto kernel = request.query().get("kernel");
+    if (!kernel || *kernel == "simd") return DenseKernel::Simd;
+    if (*kernel == "scalar") return DenseKernel::Scalar;
+    throw std::invalid_argument("kernel must be \"scalar\" or \"simd\"");
+}
 
-        iteration["neighbors"] = neighbors;
-        iteration["updated_distances"] = updated_distances;
-        iterations.push_back(iteration);
-    }
+// The vector kernel, logging the same iterations as dijkstra()
+void simdDijkstra(const DenseMatrix &graph, int src, std::vector<int> &distances,
+                  const IterationSink &emit, TraceFormat format = TraceFormat::Full) {
+    vectorDijkstra(graph, src, distances, [&](int u, const std::vector<int> &relaxed) {
+        emit(iterationRecord(u, relaxed, distances, format));
+    });
 }
 
 // CORS Headers setup
@@ -68,70 +110,419 @@ void handleOptions(const Rest::Request& request, Http::ResponseWriter response)
     response.send(Http::Code::Ok);
 }
 
+// Parse the optional ?stream= query parameter; "ndjson" streams the trace
+bool parseStreamMode(const Rest::Request& request) {
+    const auto stream = request.query().get("stream");
+    if (!stream) return false;
+    if (*stream == "ndjson") return true;
+    throw std::invalid_argument("stream must be \"ndjson\"");
+}
+
+// Destination of a solver's iterations. Buffered, the response is one JSON
+// object sent at the end. Streamed, the response is chunked newline-delimited
+// JSON: {"iterations": [...]} lines flushed while the solver runs, then one
+// {"final_distances": [...]} line. Each iteration is serialized as it
+// arrives, so a stream holds at most one batch in memory. Errors go through
+// fail(), since a stream has already sent its status.
+class TraceOutput {
+public:
+    explicit TraceOutput(Http::ResponseWriter& response) : response(response) {}
+
+    // Pick the response form; a stream sends its 200 status now
+    void start(bool streamed) {
+        if (streamed) {
+            response.setMime(Http::Mime::MediaType::fromString("application/x-ndjson"));
+            stream.emplace(response.stream(Http::Code::Ok));
+        }
+    }
+
+    void add(json&& iteration) {
+        if (!stream) {
+            iterations.push_back(std::move(iteration));
+            return;
+        }
+        batch += batch.empty() ? "{\"iterations\":[" : ",";
+        batch += iteration.dump();
+        if (++batchSize >= MAX_BATCH_ITERATIONS || batch.size() >= MAX_BATCH_BYTES) flush();
+    }
+
+    void finish(json&& final_distances) {
+        if (!stream) {
+            json response_json;
+            response_json["iterations"] = std::move(iterations);
+            response_json["final_distances"] = std::move(final_distances);
+            response.send(Http::Code::Ok, response_json.dump(), MIME(Application, Json));
+            return;
+        }
+        flush();
+        *stream << json{{"final_distances", std::move(final_distances)}}.dump() + "\n";
+        *stream << Http::ends;
+    }
+
+    // Answer an error with its status while nothing has been sent; once
+    // streaming, log it and end the stream, which the client sees cut short
+    void fail(Http::Code code, const std::string& message) {
+        if (!stream) {
+            response.send(code, message);
+            return;
+        }
+        async_log::warn("Trace stream ended early", {{"error", message}});
+        try {
+            *stream << Http::ends;
+        } catch (const std::exception&) {
+            // The client is gone, typically what failed in the first place
+        }
+    }
+
+private:
+    static constexpr size_t MAX_BATCH_ITERATIONS = 64;
+    static constexpr size_t MAX_BATCH_BYTES = 64 * 1024;
+
+    Http::ResponseWriter& response;
+    std::optional<Http::ResponseStream> stream;
+    json iterations = json::array();
+    std::string batch;
+    size_t batchSize = 0;
+
+    void flush() {
+        if (batch.empty()) return;
+        batch += "]}\n";
+        *stream << batch;
+        *stream << Http::flush;
+        batch.clear();
+        batchSize = 0;
+    }
+};
+
+// Edge-list or adjacency-list body: heap Dijkstra over CSR, always with the compact trace
+void handleSparseDijkstra(const json& body, bool streamed, Http::ResponseWriter& response, TraceOutput& output) {
+    CsrGraph graph = CsrGraph::fromJson(body);
+    if (graph.nodeCount() == 0) {
+        response.send(Http::Code::Bad_Request, "Graph has no nodes");
+        return;
+    }
+    const int64_t source = body.value("source", int64_t{0});
+    if (source < 0 || static_cast<size_t>(source) >= graph.nodeCount()) {
+        response.send(Http::Code::Bad_Request, "source is out of range");
+        return;
+    }
+
+    output.start(streamed);
+    std::vector<int64_t> distances;
+    heapDijkstra(graph, static_cast<uint32_t>(source), distances,
+                 [&output](json&& iteration) { output.add(std::move(iteration)); });
+
+    json final_distances = json::array();
+    for (int64_t d : distances) {
+        final_distances.push_back(d == UNREACHABLE ? json(nullptr) : json(d));
+    }
+    output.finish(std::move(final_distances));
+}
+
 // Handler for the API endpoint that runs Dijkstra's algorithm
 void handleDijkstra(const Rest::Request& request, Http::ResponseWriter response) {
     setupCORSHeaders(response);
-    
+    TraceOutput output(response);
+
     try {
-        auto body = json::parse(request.body());
-        std::vector<std::vector<int>> graph;
+        const std::optional<TraceFormat> trace = parseTraceFormat(request);
+        const bool streamed = parseStreamMode(request);
+        const DenseKernel kernel = parseDenseKernel(request);
+
+        // Binary bodies are dense matrices read in place; see DenseMatrix for the layout
+        const auto contentType = request.headers().tryGet<Http::Header::ContentType>();
+        const bool binary = contentType && contentType->mime() == MIME(Application, OctetStream);
+
+        std::optional<DenseMatrix> parsed;
+        if (binary) {
+            parsed = DenseMatrix::fromBinary(request.body());
+        } else {
+            auto body = json::parse(request.body());
 
-        for (const auto& row : body) {
-            std::vector<int> temp;
-            for (const auto& elem : row) {
-                temp.push_back(elem);
+            // Objects describe sparse graphs or a packed upper triangle, a bare
+            // array is the dense adjacency matrix
+            if (body.is_object() && !body.contains("upper_triangle")) {
+                if (trace == TraceFormat::Full) {
+                    response.send(Http::Code::Bad_Request, "Sparse graphs only support the compact trace");
+                    return;
+                }
+                handleSparseDijkstra(body, streamed, response, output);
+                return;
             }
-            graph.push_back(temp);
+            parsed = DenseMatrix::fromJson(body);
+        }
+        const DenseMatrix& graph = *parsed;
+        if (graph.size() == 0) {
+            response.send(Http::Code::Bad_Request, "Graph has no nodes");
+            return;
         }
 
         // Apply Dijkstra's algorithm
+        output.start(streamed);
         std::vector<int> distances;
-        json iterations = json::array();
-        dijkstra(graph, 0, distances, iterations);
+        const IterationSink emit = [&output](json&& iteration) { output.add(std::move(iteration)); };
+        if (kernel == DenseKernel::Simd) {
+            simdDijkstra(graph, 0, distances, emit, trace.value_or(TraceFormat::Full));
+        } else {
+            dijkstra(graph, 0, distances, emit, trace.value_or(TraceFormat::Full));
+        }
+
+        async_log::info("Solved dense graph", {
+            {"nodes", graph.size()},
+            {"kernel", kernel == DenseKernel::Simd ? (avx2Available() ? "avx2" : "flat_scalar") : "scalar"}
+        });
+        output.finish(distances);
+    } catch (const std::invalid_argument &e) {
+        output.fail(Http::Code::Bad_Request, e.what());
+    } catch (const json::exception &e) {
+        output.fail(Http::Code::Bad_Request, "Invalid JSON format");
+    } catch (const std::exception &e) {
+        async_log::error("Dijkstra failed", {{"error", e.what()}});
+        output.fail(Http::Code::Internal_Server_Error, "Internal server error");
+    }
+}
+
+// Handler for grid searches. The body is {"width", "height", "rows": [hex, ...],
+// "start": [x, y], "goal": [x, y]} plus optional "connectivity" (4 or 8, default 8),
+// "algorithm" ("jps" or "bfs", default "jps") and "expanded" (default true)
+void handleGrid(const Rest::Request& request, Http::ResponseWriter response) {
+    setupCORSHeaders(response);
+
+    try {
+        auto body = json::parse(request.body());
+        const BitGrid grid(body.at("width").get<int>(), body.at("height").get<int>(),
+                           body.at("rows").get<std::vector<std::string>>());
+        const Cell start{body.at("start").at(0).get<int>(), body.at("start").at(1).get<int>()};
+        const Cell goal{body.at("goal").at(0).get<int>(), body.at("goal").at(1).get<int>()};
+
+        const int connectivity = body.value("connectivity", 8);
+        if (connectivity != 4 && connectivity != 8) {
+            throw std::invalid_argument("connectivity must be 4 or 8");
+        }
+        const std::string algorithm = body.value("algorithm", std::string("jps"));
+        const bool recordExpanded = body.value("expanded", true);
+
+        GridSearchResult result;
+        if (algorithm == "jps") {
+            result = jumpPointSearch(grid, start, goal, static_cast<Connectivity>(connectivity), recordExpanded);
+        } else if (algorithm == "bfs") {
+            result = bitParallelBfs(grid, start, goal, static_cast<Connectivity>(connectivity), recordExpanded);
+        } else {
+            throw std::invalid_argument("algorithm must be \"jps\" or \"bfs\"");
+        }
 
-        // Prepare the response JSON
         json response_json;
-        response_json["iterations"] = iterations;
-        response_json["final_distances"] = distances;
-        std::cout << response_json.dump() << std::endl;
+        response_json["path"] = result.path;
+        response_json["cost"] = result.path.empty() ? json(nullptr) : json(result.cost);
+        response_json["expanded_count"] = result.expanded.size();
+        if (recordExpanded) response_json["expanded"] = result.expanded;
+
+        async_log::info("Searched grid", {
+            {"width", grid.width()},
+            {"height", grid.height()},
+            {"algorithm", algorithm},
+            {"expanded", result.expanded.size()}
+        });
         response.send(Http::Code::Ok, response_json.dump(), MIME(Application, Json));
+    } catch (const std::invalid_argument &e) {
+        response.send(Http::Code::Bad_Request, e.what());
     } catch (const std::exception &e) {
         response.send(Http::Code::Bad_Request, "Invalid JSON format");
     }
 }
 
+// Quadratic algorithms are refused when all runs together would do more elementary steps than this
+constexpr double MAX_COMPARISON_WORK = 1e9;
+
+// Handler for side-by-side runs of several algorithms on one graph. The body is
+// any sparse graph form plus "source" (default 0), optional "target",
+// "algorithms" (default all), "coordinates" ([[x, y], ...] for A*) and "runs"
+// (1-50, default 1). Times come from the monotonic steady clock. A quadratic
+// algorithm over the work limit fails the request when it was asked for by
+// name, and is reported as skipped when it only came with the default set.
+void handleCompare(const Rest::Request& request, Http::ResponseWriter response) {
+    setupCORSHeaders(response);
+
+    try {
+        auto body = json::parse(request.body());
+        if (!body.is_object()) throw std::invalid_argument("Body must be a JSON object");
+
+        std::optional<uint32_t> target;
+        if (body.contains("target")) target = body.at("target").get<uint32_t>();
+        std::vector<std::pair<double, double>> coordinates;
+        if (body.contains("coordinates")) coordinates = body.at("coordinates").get<std::vector<std::pair<double, double>>>();
+        const ComparisonInput input(CsrGraph::fromJson(body), body.value("source", uint32_t{0}), target,
+                                    std::move(coordinates));
+
+        std::vector<Algorithm> algorithms;
+        const bool explicitAlgorithms = body.contains("algorithms");
+        if (explicitAlgorithms) {
+            for (const auto& name : body.at("algorithms")) {
+                const auto algorithm = parseAlgorithm(name.get<std::string>());
+                if (!algorithm) throw std::invalid_argument("Unknown algorithm " + name.dump());
+                algorithms.push_back(*algorithm);
+            }
+        } else {
+            algorithms = {Algorithm::Bfs, Algorithm::ArrayDijkstra, Algorithm::HeapDijkstra,
+                          Algorithm::BellmanFord};
+            if (target) {
+                algorithms.push_back(Algorithm::AStar);
+                algorithms.push_back(Algorithm::Bidirectional);
+            }
+        }
+
+        const int runs = body.value("runs", 1);
+        if (runs < 1 || runs > 50) throw std::invalid_argument("runs must be between 1 and 50");
+
+        const double V = static_cast<double>(input.graph().nodeCount());
+        const double E = static_cast<double>(input.graph().targets.size());
+        json results = json::array();
+        for (Algorithm algorithm : algorithms) {
+            const double work = algorithm == Algorithm::ArrayDijkstra ? V * V
+                              : algorithm == Algorithm::BellmanFord ? V * E : 0.0;
+            if (work * runs > MAX_COMPARISON_WORK) {
+                const std::string reason = std::string(algorithmName(algorithm)) +
+                                           " is too slow for a graph this large at this many runs";
+                if (explicitAlgorithms) throw std::invalid_argument(reason);
+                results.push_back({{"algorithm", algorithmName(algorithm)}, {"skipped", reason}});
+                continue;
+            }
+
+            ComparisonResult result;
+            std::vector<double> times;
+            for (int run = 0; run < runs; ++run) {
+                const auto started = std::chrono::steady_clock::now();
+                result = runAlgorithm(algorithm, input);
+                const auto stopped = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::milli>(stopped - started).count());
+            }
+            std::sort(times.begin(), times.end());
+
+            json entry = {
+                {"algorithm", algorithmName(algorithm)},
+                {"time_ms", times[times.size() / 2]},
+                {"min_time_ms", times.front()},
+                {"settled", result.counters.settled},
+                {"relaxations", result.counters.relaxations},
+                {"heap_operations", result.counters.heapOperations},
+                {"reached", result.reached}
+            };
+            if (target) {
+                entry["distance"] = result.distance == UNREACHABLE ? json(nullptr) : json(result.distance);
+            }
+            // BFS counts hops, so its distance is not comparable with the others
+            if (algorithm == Algorithm::Bfs) entry["weighted"] = false;
+            results.push_back(std::move(entry));
+        }
+
+        json response_json;
+        response_json["nodes"] = input.graph().nodeCount();
+        response_json["edges"] = input.graph().targets.size();
+        response_json["runs"] = runs;
+        response_json["results"] = std::move(results);
+
+        response.send(Http::Code::Ok, response_json.dump(), MIME(Application, Json));
+    } catch (const std::invalid_argument &e) {
+        response.send(Http::Code::Bad_Request, e.what());
+    } catch (const std::exception &e) {
+        response.send(Http::Code::Bad_Request, "Invalid JSON format");
+    }
+}
+
+// Wrap a handler so it runs on the compute pool. The request is copied into
+// the job because Pistache only guarantees it for the duration of the call;
+// the writer is moved there and answered from the worker. The copy's body
+// counts against the pool's byte budget. A full queue or budget is answered
+// straight away with 503.
+Rest::Route::Handler offloaded(ComputePool& pool, void (*handler)(const Rest::Request&, Http::ResponseWriter)) {
+    return [&pool, handler](const Rest::Request& request, Http::ResponseWriter response) {
+        auto job = std::make_shared<std::pair<Rest::Request, Http::ResponseWriter>>(request, std::move(response));
+        const size_t bytes = job->first.body().size();
+        if (!pool.submit([job, handler] { handler(job->first, std::move(job->second)); }, bytes)) {
+            setupCORSHeaders(job->second);
+            job->second.send(Http::Code::Service_Unavailable, "Server is busy, try again later");
+        }
+        return Rest::Route::Result::Ok;
+    };
+}
+
 // Set up the routes
-void setupRoutes(Rest::Router& router) {
+void setupRoutes(Rest::Router& router, ComputePool& pool) {
     using namespace Rest;
 
     // Handle CORS preflight requests
     Routes::Options(router, "/api/dijkstra", Routes::bind(&handleOptions));
 
     // Route for running Dijkstra's algorithm
-    Routes::Post(router, "/api/dijkstra", Routes::bind(&handleDijkstra));
+    Routes::Post(router, "/api/dijkstra", offloaded(pool, &handleDijkstra));
+
+    // Route for searches on packed wall grids
+    Routes::Options(router, "/api/grid", Routes::bind(&handleOptions));
+    Routes::Post(router, "/api/grid", offloaded(pool, &handleGrid));
+
+    // Route for comparing algorithms on one graph
+    Routes::Options(router, "/api/compare", Routes::bind(&handleOptions));
+    Routes::Post(router, "/api/compare", offloaded(pool, &handleCompare));
+}
+
+// Positive integer from the environment, or the fallback if unset or invalid
+size_t envCount(const char* name, size_t fallback) {
+    const char* value = std::getenv(name);
+    if (!value) return fallback;
+    char* end = nullptr;
+    const unsigned long parsed = std::strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || parsed == 0) {
+        async_log::warn("Ignoring environment variable, expected a positive integer", {{"name", name}, {"value", value}});
+        return fallback;
+    }
+    return parsed;
 }
 
 int main() {
+    // Structured logs go to stdout from a background thread; see async_log for LOG_LEVEL and friends
+    async_log::start(async_log::optionsFromEnvironment());
+
+    // Thread counts: GRIDGUIDE_IO_THREADS serve HTTP, GRIDGUIDE_COMPUTE_THREADS
+    // run solvers, and at most GRIDGUIDE_QUEUE_CAPACITY solves wait for one
+    const size_t ioThreads = envCount("GRIDGUIDE_IO_THREADS", 2);
+    const size_t computeThreads = envCount("GRIDGUIDE_COMPUTE_THREADS",
+                                           std::max(1u, std::thread::hardware_concurrency()));
+    const size_t queueCapacity = envCount("GRIDGUIDE_QUEUE_CAPACITY", 64);
+    // The largest body accepted, a full int32 binary matrix of the most nodes;
+    // Pistache's own default is 4 KiB
+    const size_t largestMatrix = DenseMatrix::HEADER_BYTES +
+        DenseMatrix::cellCount(DenseMatrix::MAX_NODES, MatrixLayout::Full) * sizeof(int32_t);
+    const size_t maxRequestBytes = envCount("GRIDGUIDE_MAX_REQUEST_BYTES", largestMatrix);
+    // Request bodies queued or being solved, at least room for one of the largest
+    const size_t queueBytes = std::max(envCount("GRIDGUIDE_QUEUE_BYTES", 4 * maxRequestBytes), maxRequestBytes);
+
     // Allow binding to all interfaces (important for Docker)
     Http::Endpoint server(Address(Ipv4::any(), Port(9080)));
 
     // Initialize the server
     auto opts = Http::Endpoint::options()
-        .threads(2)
-        .flags(Tcp::Options::ReuseAddr);
+        .threads(static_cast<int>(ioThreads))
+        .flags(Tcp::Options::ReuseAddr)
+        .maxRequestSize(maxRequestBytes);
     server.init(opts);
 
+    // Solvers run here, off the I/O threads
+    ComputePool pool(computeThreads, queueCapacity, queueBytes);
+
     // Set up the router
     Rest::Router router;
-    setupRoutes(router);
+    setupRoutes(router, pool);
 
     // Bind the router to the server
     server.setHandler(router.handler());
 
-    std::cout << "Server is listening on http://0.0.0.0:9080" << std::endl;
+    async_log::info("Server is listening on http://0.0.0.0:9080", {
+        {"io_threads", ioThreads},
+        {"compute_threads", computeThreads}
+    });
 
     // Start the server
     server.serve();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,129 @@
+#include "sparse.hpp"
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <shortest_path/search.hpp>
+
+namespace {
+
+// Largest graph accepted, keeps node ids within uint32_t with room to spare
+constexpr uint64_t MAX_NODES = 1u << 24;
+
+uint32_t checkedNode(const json &value, size_t nodeCount) {
+    const int64_t node = value.get<int64_t>();
+    if (node < 0 || static_cast<uint64_t>(node) >= nodeCount) {
+        throw std::invalid_argument("Node " + std::to_string(node) + " is out of range");
+    }
+    return static_cast<uint32_t>(node);
+}
+
+int checkedWeight(const json &value) {
+    const int weight = value.get<int>();
+    if (weight < 0) {
+        throw std::invalid_argument("Edge weights must not be negative");
+    }
+    return weight;
+}
+
+} // namespace
+
+CsrGraph CsrGraph::fromJson(const json &body) {
+    std::vector<std::tuple<uint32_t, uint32_t, int>> edges;
+    size_t nodeCount = 0;
+
+    if (body.contains("matrix")) {
+        const json &matrix = body.at("matrix");
+        nodeCount = matrix.size();
+        if (nodeCount > MAX_NODES) throw std::invalid_argument("Too many nodes");
+        for (size_t u = 0; u < nodeCount; ++u) {
+            if (matrix[u].size() != nodeCount) throw std::invalid_argument("matrix must be square");
+            for (size_t v = 0; v < nodeCount; ++v) {
+                const int w = checkedWeight(matrix[u][v]);
+                if (w != 0 && u != v) edges.emplace_back(static_cast<uint32_t>(u), static_cast<uint32_t>(v), w);
+            }
+        }
+    } else if (body.contains("adjacency")) {
+        const json &adjacency = body.at("adjacency");
+        nodeCount = adjacency.size();
+        if (nodeCount > MAX_NODES) throw std::invalid_argument("Too many nodes");
+        for (size_t u = 0; u < nodeCount; ++u) {
+            for (const auto &entry : adjacency[u]) {
+                edges.emplace_back(static_cast<uint32_t>(u), checkedNode(entry.at(0), nodeCount), checkedWeight(entry.at(1)));
+            }
+        }
+    } else {
+        const int64_t nodes = body.at("nodes").get<int64_t>();
+        if (nodes < 0 || static_cast<uint64_t>(nodes) > MAX_NODES) {
+            throw std::invalid_argument("nodes must be between 0 and " + std::to_string(MAX_NODES));
+        }
+        nodeCount = static_cast<size_t>(nodes);
+        const bool directed = body.value("directed", false);
+        const json &list = body.at("edges");
+        edges.reserve(directed ? list.size() : 2 * list.size());
+        for (const auto &edge : list) {
+            const uint32_t u = checkedNode(edge.at(0), nodeCount);
+            const uint32_t v = checkedNode(edge.at(1), nodeCount);
+            const int w = checkedWeight(edge.at(2));
+            edges.emplace_back(u, v, w);
+            if (!directed) edges.emplace_back(v, u, w);
+        }
+    }
+
+    // Counting sort of the edges by source
+    CsrGraph graph;
+    graph.offsets.assign(nodeCount + 1, 0);
+    for (const auto &[u, v, w] : edges) ++graph.offsets[u + 1];
+    for (size_t u = 0; u < nodeCount; ++u) graph.offsets[u + 1] += graph.offsets[u];
+    graph.targets.resize(edges.size());
+    graph.weights.resize(edges.size());
+    std::vector<uint32_t> cursor(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto &[u, v, w] : edges) {
+        const uint32_t slot = cursor[u]++;
+        graph.targets[slot] = v;
+        graph.weights[slot] = w;
+    }
+    return graph;
+}
+
+CsrGraph CsrGraph::reversed() const {
+    const size_t V = nodeCount();
+    CsrGraph reverse;
+    reverse.offsets.assign(V + 1, 0);
+    for (uint32_t v : targets) ++reverse.offsets[v + 1];
+    for (size_t v = 0; v < V; ++v) reverse.offsets[v + 1] += reverse.offsets[v];
+    reverse.targets.resize(targets.size());
+    reverse.weights.resize(weights.size());
+    std::vector<uint32_t> cursor(reverse.offsets.begin(), reverse.offsets.end() - 1);
+    for (uint32_t u = 0; u < V; ++u) {
+        for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            const uint32_t slot = cursor[targets[e]]++;
+            reverse.targets[slot] = u;
+            reverse.weights[slot] = weights[e];
+        }
+    }
+    return reverse;
+}
+
+void heapDijkstra(const CsrGraph &graph, uint32_t src, std::vector<int64_t> &distances, const IterationSink &emit) {
+    // Logs each settled node with the distances it lowered
+    struct Trace : shortest_path::SearchVisitor {
+        const IterationSink &emit;
+        const std::vector<int64_t> &distances;
+        json updates = json::array();
+
+        Trace(const IterationSink &emit, const std::vector<int64_t> &distances) : emit(emit), distances(distances) {}
+
+        void improve(uint32_t, uint32_t v, size_t) { updates.push_back({v, distances[v]}); }
+        bool scanned(uint32_t u) {
+            emit({
+                {"current_node", u},
+                {"updates", std::move(updates)}
+            });
+            updates = json::array();
+            return true;
+        }
+    } trace(emit, distances);
+
+    shortest_path::search<int64_t, shortest_path::BinaryHeapQueue>(
+        graph.layout(), src, shortest_path::NO_TARGET, distances, shortest_path::ZeroHeuristic<int64_t>{}, trace);
+}
@@ -0,0 +1,52 @@
+#ifndef SPARSE_HPP
+#define SPARSE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <shortest_path/layouts.hpp>
+
+using json = nlohmann::json;
+
+// Receives a solver's iteration records one at a time, so a trace can be collected or streamed
+using IterationSink = std::function<void(json &&)>;
+
+// Distance of nodes the source cannot reach, as the shortest path library reports it
+constexpr int64_t UNREACHABLE = std::numeric_limits<int64_t>::max();
+
+// Graph in compressed sparse row form: the edges leaving u are
+// targets[offsets[u]] .. targets[offsets[u + 1] - 1], with matching weights
+struct CsrGraph {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<int> weights;
+
+    size_t nodeCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    // View for the shared shortest path library, valid while the graph is unchanged
+    shortest_path::CsrLayout<int> layout() const {
+        return {offsets.data(), targets.data(), weights.data(), nodeCount()};
+    }
+
+    /**
+     * Build from an edge list {"nodes": V, "edges": [[u, v, w], ...], "directed": false},
+     * an adjacency list {"adjacency": [[[v, w], ...], ...]} (one list per node)
+     * or a dense matrix {"matrix": [[w, ...], ...]} where 0 means no edge
+     * @throws std::invalid_argument for out-of-range nodes or negative weights
+     */
+    static CsrGraph fromJson(const json& body);
+
+    // The same graph with every edge turned around
+    CsrGraph reversed() const;
+};
+
+/**
+ * Dijkstra with a binary heap and lazy deletion, O((V + E) log V)
+ * @param distances Receives the distance of every node, UNREACHABLE if there is none
+ * @param emit Receives one {"current_node", "updates": [[node, distance], ...]} per settled node
+ */
+void heapDijkstra(const CsrGraph &graph, uint32_t src, std::vector<int64_t> &distances, const IterationSink &emit);
+
+#endif // SPARSE_HPP
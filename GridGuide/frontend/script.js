@@ -155,58 +155,80 @@ function generateRandom() {
 
 async function generateGraphFromMatrix(adjMatrix) {
   drawGraph(svg, adjMatrix);
-  const result = await fetchResult(adjMatrix);
-  /* const links2 = [];
-  for (let i = 0; i < adjMatrix.length; i++) {
-    for (let j = i + 1; j < adjMatrix[i].length; j++) {
-      if (adjMatrix[i][j] !== 0) {
-        links2.push({
-          source: i,
-          target: j,
-          weight: adjMatrix[i][j],
-        });
-      }
-    }
-  } */
-  console.log("reached here");
-  console.log(result);
-  const edgesArray = result.iterations.map((element) => ({
-    edges: getEdge(element.current_node, element.neighbors.map((value, index) => value === 1 ? index : -1)
-      .filter(index => index !== -1)),
-    source: element.current_node,
-    distances: (function(element) {
+  // Steps are animated as they arrive; the animation waits for more while the stream is open
+  const steps = { items: [], done: false, resume: null };
+  const wake = () => {
+    const resume = steps.resume;
+    steps.resume = null;
+    if (resume) resume();
+  };
+  // The compact trace only lists changed distances; replay them to get each step's table
+  const distances = adjMatrix.map((_, index) => index === 0 ? 0 : 2147483647);
+  const addIterations = (iterations) => {
+    iterations.forEach((element) => {
+      element.updates.forEach(([node, distance]) => { distances[node] = distance; });
       let formattedString = 'Distance of nodes:\n\n';
-      console.log("updated_distances", element);
-      element.forEach((distance, index) => {
+      distances.forEach((distance, index) => {
         const formattedDistance = distance === 2147483647 ? 'infinity' : distance;
         formattedString += `  Node ${index} : ${formattedDistance}\n`;
       });
-      return formattedString;
-    })(element.updated_distances)
-  }));
+      steps.items.push({
+        edges: getEdge(element.current_node, element.updates.map(([node]) => node)),
+        source: element.current_node,
+        distances: formattedString
+      });
+    });
+    wake();
+  };
   console.log(adjMatrix);
-  console.log(edgesArray);
-  setTimeout(() => animateEdgesSequentially(edgesArray), 1000);
+  setTimeout(() => animateEdgesSequentially(steps), 1000);
+  await fetchResult(adjMatrix, addIterations);
+  steps.done = true;
+  wake();
 }
 
 generateRandom();
 
 
-async function fetchResult(adjacencyMatrix) {
-  const response = await fetch('http://localhost:9080/api/dijkstra', {
+// The matrix is symmetric, so only the cells right of the diagonal are sent
+function upperTriangle(adjacencyMatrix) {
+  const cells = [];
+  adjacencyMatrix.forEach((row, i) => {
+    for (let j = i + 1; j < row.length; j++) cells.push(row[j]);
+  });
+  return { nodes: adjacencyMatrix.length, upper_triangle: cells };
+}
+
+async function fetchResult(adjacencyMatrix, onIterations) {
+  const response = await fetch('http://localhost:9080/api/dijkstra?trace=compact&stream=ndjson', {
     method: 'POST',
     headers: {
       'Content-Type': 'application/json'
     },
-    body: JSON.stringify(adjacencyMatrix)
+    body: JSON.stringify(upperTriangle(adjacencyMatrix))
   })
   if (!response.ok) {
     throw new Error(`HRRP error! ${response.status}`)
   }
-  const data = await response.json();
-  const iterations = data.iterations;
-  const finalDistances = data.final_distances;
-  return { iterations, finalDistances };
+  // Newline-delimited JSON: batches of iterations, then the final distances
+  const reader = response.body.getReader();
+  const decoder = new TextDecoder();
+  let buffered = '';
+  let finalDistances = [];
+  while (true) {
+    const { value, done } = await reader.read();
+    if (done) break;
+    buffered += decoder.decode(value, { stream: true });
+    const lines = buffered.split('\n');
+    buffered = lines.pop();
+    for (const line of lines) {
+      if (!line) continue;
+      const message = JSON.parse(line);
+      if (message.iterations) onIterations(message.iterations);
+      if (message.final_distances) finalDistances = message.final_distances;
+    }
+  }
+  return { finalDistances };
   /* .then(response => response.json())
   .then(data => {
     const iterations = data.iterations;
@@ -246,8 +268,12 @@ function drag(simulation) {
     .on("end", dragended);
 }
 
-function animateEdgesSequentially(edges, index = 0) {
-  if (index === edges.length) return;
+function animateEdgesSequentially(steps, index = 0) {
+  if (index === steps.items.length) {
+    if (!steps.done) steps.resume = () => animateEdgesSequentially(steps, index);
+    return;
+  }
+  const edges = steps.items;
   const current_node = d3.selectAll('circle')._groups[0][edges[index].source];
   current_node.setAttribute("stroke", "red");
   current_node.setAttribute("stroke-width", "5");
@@ -258,7 +284,7 @@ function animateEdgesSequentially(edges, index = 0) {
       document.getElementById("result").innerText = edges[index].distances;
       current_node.removeAttribute("stroke");
       current_node.removeAttribute("stroke-width");
-      animateEdgesSequentially(edges, index + 1);
+      animateEdgesSequentially(steps, index + 1);
     })
   }, 500)
 }
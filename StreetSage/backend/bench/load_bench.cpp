@@ -0,0 +1,79 @@
+// Times Graph::loadFromJSON on a synthetic street grid at 1, 2, 4, ... threads
+// up to the hardware thread count, so the scaling of the parallel load can be
+// checked on the machine it runs on.
+// Usage: load_bench [side] [runs]   (side x side nodes, default 600; median of runs, default 5)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "graph.hpp"
+
+namespace {
+
+int runs = 5;
+
+// Overpass-shaped grid: jittered nodes, one way per row and per column
+json streetGrid(int side, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> jitter(-0.0002, 0.0002);
+    const char* highways[] = {"residential", "primary", "tertiary", "motorway"};
+
+    json elements = json::array();
+    for (int row = 0; row < side; ++row) {
+        for (int col = 0; col < side; ++col) {
+            elements.push_back({{"type", "node"}, {"id", int64_t(row) * side + col + 1},
+                                {"lat", 51.5 + row * 0.001 + jitter(rng)},
+                                {"lon", -0.1 + col * 0.0015 + jitter(rng)}});
+        }
+    }
+    for (int line = 0; line < side; ++line) {
+        json row = json::array(), col = json::array();
+        for (int k = 0; k < side; ++k) {
+            row.push_back(int64_t(line) * side + k + 1);
+            col.push_back(int64_t(k) * side + line + 1);
+        }
+        elements.push_back({{"type", "way"}, {"id", 100000000 + line}, {"nodes", row},
+                            {"tags", {{"highway", highways[line % 4]}}}});
+        elements.push_back({{"type", "way"}, {"id", 200000000 + line}, {"nodes", col},
+                            {"tags", {{"highway", highways[(line + 1) % 4]}}}});
+    }
+    return {{"elements", elements}};
+}
+
+double medianLoad(const json& data, unsigned threads, size_t& nodes) {
+    std::vector<double> times;
+    for (int run = 0; run < runs; ++run) {
+        Graph graph;
+        const auto start = std::chrono::steady_clock::now();
+        graph.loadFromJSON(data, threads);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        nodes = graph.getNodeCount();
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int side = argc > 1 ? std::max(2, std::atoi(argv[1])) : 600;
+    if (argc > 2) runs = std::max(1, std::atoi(argv[2]));
+
+    const json data = streetGrid(side, 7);
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%zu elements, %u hardware threads\n", data["elements"].size(), hardware);
+    std::printf("%8s %10s %12s %9s\n", "threads", "nodes", "load ms", "speedup");
+
+    double single = 0;
+    for (unsigned threads = 1; ; threads = std::min(2 * threads, hardware)) {
+        size_t nodes = 0;
+        const double ms = medianLoad(data, threads, nodes);
+        if (threads == 1) single = ms;
+        std::printf("%8u %10zu %12.1f %8.2fx\n", threads, nodes, ms, single / ms);
+        if (threads == hardware) break;
+    }
+    return 0;
+}
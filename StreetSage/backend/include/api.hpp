@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <functional>
 #include <cpr/cpr.h>
 #include <cmath>
 #include "json.hpp"
@@ -10,6 +16,8 @@
 
 using json = nlohmann::json;
 
+class OverpassTileStore;
+
 struct BoundingBox {
     double min_lat;
     double min_lon;
@@ -27,6 +35,11 @@ struct BoundingBox {
         return point.lat >= min_lat && point.lat <= max_lat &&
                point.lon >= min_lon && point.lon <= max_lon;
     }
+
+    bool contains(const BoundingBox& other) const {
+        return other.min_lat >= min_lat && other.max_lat <= max_lat &&
+               other.min_lon >= min_lon && other.max_lon <= max_lon;
+    }
 };
 
 struct GeoPoint {
@@ -48,6 +61,12 @@ public:
      */
     static cpr::Response fetchOverpassData(const BoundingBox& boundingBox);
 
+    /**
+     * Serve fetches from an on-disk tile store first, and persist upstream
+     * responses into it; pass nullptr to disable
+     */
+    static void setTileStore(std::shared_ptr<OverpassTileStore> store);
+
     /**
      * Get the list of excluded highway types
      * @return Vector of excluded highway types
@@ -58,7 +77,68 @@ public:
 
 private:
     static const std::vector<std::string> highWayExclude;
+    static std::shared_ptr<OverpassTileStore> tileStore;
     static std::string constructOverpassQuery(const BoundingBox& boundingBox);
+    static uint64_t queryHash();
+};
+
+class AsyncOverpassFetcher {
+public:
+    using Callback = std::function<void(const cpr::Response&)>;
+
+    /**
+     * Start the I/O pool that performs upstream Overpass requests, and the
+     * compute pool that runs their callbacks
+     * @param threads Number of concurrent upstream requests
+     * @param computeThreads Number of callbacks run at once
+     * @param maxFlights Distinct upstream requests queued or running at once
+     * @param maxWaiters Callbacks accepted and not yet finished, over all flights
+     *                   and the compute queue, which therefore never holds more
+     */
+    explicit AsyncOverpassFetcher(size_t threads = 2, size_t computeThreads = 2, size_t maxFlights = 32,
+                                  size_t maxWaiters = 256);
+    ~AsyncOverpassFetcher();
+
+    AsyncOverpassFetcher(const AsyncOverpassFetcher&) = delete;
+    AsyncOverpassFetcher& operator=(const AsyncOverpassFetcher&) = delete;
+
+    /**
+     * Fetch Overpass data without blocking the caller. Requests whose bounding
+     * box is covered by one already queued or in flight join that request
+     * instead of issuing their own; every waiter receives the same response.
+     * @param boundingBox Area to fetch
+     * @param callback Invoked once on a compute pool thread with the response, so
+     *                 parsing and searching never hold up other fetches
+     * @return false, without keeping the callback, when the flight or waiter
+     *         limit is reached; the caller should answer 503
+     */
+    bool fetch(const BoundingBox& boundingBox, Callback callback);
+
+private:
+    struct Flight {
+        BoundingBox boundingBox;
+        std::vector<Callback> waiters;
+    };
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<Flight>> pending;
+    std::vector<std::shared_ptr<Flight>> flights;  // pending or running
+    std::vector<std::thread> workers;
+    bool stopping = false;
+    size_t maxFlights;
+    size_t maxWaiters;
+    size_t waiting = 0;  // callbacks accepted and not yet finished
+
+    // Callbacks handed over by the I/O threads, each with its flight's response
+    std::mutex computeMutex;
+    std::condition_variable computeReady;
+    std::deque<std::function<void()>> completions;
+    std::vector<std::thread> computeWorkers;
+    bool computeStopping = false;
+
+    void run();
+    void complete();
 };
 
 class BoundingBoxGenerator {
@@ -77,6 +157,14 @@ public:
      */
     BoundingBox getBoundingBox() const;
 
+    /**
+     * Bounding box enclosing a circle, e.g. the largest area a search budget can reach
+     * @param center JSON object containing {lat: double, lon: double}
+     * @param radiusKm Circle radius in kilometres
+     * @throws std::invalid_argument if input JSON is invalid
+     */
+    static BoundingBox around(const json& center, double radiusKm);
+
 private:
     GeoPoint start_point;
     GeoPoint end_point;
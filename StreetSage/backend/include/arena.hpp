@@ -0,0 +1,46 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+// Bump allocator for the state of one request.
+//
+// Searches allocate many small hash nodes and queue buffers and free them
+// all together when the request ends. A RequestArena hands them out from a
+// block owned by the calling thread, so a request costs no heap traffic once
+// the block is warm; dropping the arena releases everything at once. The
+// block grows to fit the largest request seen on its thread, and requests
+// beyond it spill to the heap through the upstream resource.
+class RequestArena {
+public:
+    RequestArena();
+    ~RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*buffer; }
+
+    // Bytes that did not fit into the thread's block
+    size_t spilled() const { return upstream.allocated; }
+
+private:
+    // Forwards to the heap and counts what it hands out
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocated = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    CountingResource upstream;
+    std::optional<std::pmr::monotonic_buffer_resource> buffer;
+    bool ownsBlock = false;
+};
+
+#endif // ARENA_HPP
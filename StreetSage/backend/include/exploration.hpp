@@ -0,0 +1,79 @@
+#ifndef EXPLORATION_HPP
+#define EXPLORATION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "crow.h"
+#include "graph.hpp"
+
+// Live search visualisation over WebSocket.
+//
+// POST /start-dijkstra snapshots the loaded graph and parks the search under
+// a request id. The client opens /exploration and sends {"request_id": id};
+// the search then runs on its own thread and streams what it settles and
+// discovers in binary frames. A batch collects everything found since the
+// last frame and is flushed at most once per time slice. The client
+// acknowledges every frame with {"ack": sequence}, and at most `window`
+// frames may be unacknowledged. While the window is full the search keeps
+// filling the batch up to `maxBatch` nodes and then waits, so a slow browser
+// slows the search down instead of queueing frames on the server.
+//
+// Frames are little-endian:
+//   u8 type, u32 sequence, then
+//   type 1 (batch): u32 settled count, u32 frontier count, settled then frontier coordinates
+//   type 2 (path, last frame): f64 length in metres, u32 count, path coordinates (count 0 if unreachable)
+// Coordinates are lat, lon in 1e-6 degrees, each a zigzag LEB128 varint of
+// the difference to the previous coordinate of the same list.
+class ExplorationHub {
+public:
+    struct Options {
+        size_t window = 4;                       // unacknowledged frames per socket
+        size_t maxBatch = 4096;                  // nodes per batch frame
+        std::chrono::milliseconds slice{30};     // minimum time between batch frames
+        std::chrono::seconds pendingTimeout{60}; // unclaimed searches are dropped after this
+        size_t maxExplorations = 16;             // pending plus running, each holds a graph snapshot
+    };
+
+    explicit ExplorationHub(Options options);
+    ExplorationHub() : ExplorationHub(Options{}) {}
+
+    // Stops and joins every running stream
+    ~ExplorationHub();
+
+    ExplorationHub(const ExplorationHub&) = delete;
+    ExplorationHub& operator=(const ExplorationHub&) = delete;
+
+    /**
+     * Snapshot the graph for a search and keep it until a socket claims it
+     * @throws std::invalid_argument if either node is not in the graph
+     * @return Request id for the socket; empty if too many explorations are open
+     */
+    std::string prepare(const Graph& graph, int64_t start, int64_t end, Weighting weighting);
+
+    // WebSocket events of /exploration
+    void onMessage(crow::websocket::connection& conn, const std::string& data);
+    void onClose(crow::websocket::connection& conn);
+
+private:
+    struct Snapshot;  // dense copy of what the search needs
+    struct Stream;    // one claimed search and its socket
+
+    struct Pending {
+        std::shared_ptr<const Snapshot> snapshot;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    Options options;
+    std::mutex mutex;
+    std::unordered_map<std::string, Pending> pending;
+    std::unordered_map<crow::websocket::connection*, std::shared_ptr<Stream>> streams;
+
+    void run(Stream& stream, const Snapshot& snapshot) const;
+    static void stop(Stream& stream);
+};
+
+#endif // EXPLORATION_HPP
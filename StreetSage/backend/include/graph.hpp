@@ -1,8 +1,12 @@
 #ifndef GRAPH_HPP
 #define GRAPH_HPP
 
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
+#include <algorithm>
+#include <array>
+#include <string>
 #include <utility>
 #include <cstdint>
 #include "json.hpp"
@@ -21,25 +25,152 @@ struct PairHash {
     }
 };
 
+// Piecewise-linear congestion profile over a 24 hour cycle, applied as a
+// multiplier to an edge's free-flow car travel time. Breakpoints are
+// resampled onto fixed 15 minute knots so that evaluation is a single lerp.
+struct TravelTimeProfile {
+    static constexpr int SLOT_SECONDS = 900;
+    static constexpr int SLOTS = 86400 / SLOT_SECONDS;
+    // Longest free-flow edge time for which FIFO (no overtaking by departing later) is checked
+    static constexpr double MAX_FIFO_EDGE_SECONDS = 600.0;
+
+    std::string name;
+    std::array<float, SLOTS + 1> multiplierKnots{};
+    double minMultiplier = 0.0;
+
+    /**
+     * Build a profile from congestion breakpoints
+     * @param name Profile name (usually a group of highway classes)
+     * @param breakpoints {hour of day, travel time multiplier} pairs, repeated daily
+     * @throws std::invalid_argument if the breakpoints are invalid or violate FIFO
+     */
+    static TravelTimeProfile fromBreakpoints(const std::string& name,
+                                             const std::vector<std::pair<double, double>>& breakpoints);
+
+    double multiplier(double secondOfDay) const {
+        const double slot = secondOfDay * (1.0 / SLOT_SECONDS);
+        // Clamped so the end of the day still has a following knot
+        const int i = std::min(static_cast<int>(slot), SLOTS - 1);
+        const double frac = slot - i;
+        return multiplierKnots[i] + (multiplierKnots[i + 1] - multiplierKnots[i]) * frac;
+    }
+};
+
+// Edge weightings kept as parallel arrays over a single topology
+enum class Weighting : uint8_t {
+    Distance,  // metres, ignores oneway like the original graph
+    CarTime,   // seconds, from maxspeed or the highway class; respects oneway
+    BikeTime,  // seconds; respects oneway, motorways and trunks are closed
+    Count
+};
+
+constexpr size_t WEIGHTING_COUNT = static_cast<size_t>(Weighting::Count);
+
+/**
+ * Parse a request's routing profile name ("distance", "car" or "bike")
+ * @throws std::invalid_argument for unknown names
+ */
+Weighting parseWeighting(const std::string& name);
+
+// Adjacency entry. id indexes the per-weighting arrays, profile indexes the
+// shared congestion profile table. Bearings (degrees, clockwise from north)
+// are taken at both ends of the edge at load time so turn costs never need
+// trigonometry during a search. Both directions of a way are always stored;
+// a direction that a weighting may not use has an infinite weight there.
+// The two directions of a segment get consecutive ids, so id ^ 1 is the twin.
+struct Edge {
+    int64_t to;
+    double distance;
+    uint32_t id;
+    uint16_t profile;
+    float bearingOut;  // heading when leaving the source node
+    float bearingIn;   // heading when arriving at the destination node
+};
+
+// Turn penalties for edge-based routing, in metres of equivalent distance;
+// time weightings convert them at the graph's fastest speed
+struct TurnCosts {
+    double turnPenalty = 60.0;    // charged in full for a 180 degree change of heading
+    double uTurnPenalty = 300.0;  // extra charge for turning back along the edge just used
+
+    double penalty(double bearingIn, double bearingOut, bool uTurn) const {
+        const double change = (bearingOut - bearingIn) * M_PI / 180;
+        return turnPenalty * (1 - std::cos(change)) / 2 + (uTurn ? uTurnPenalty : 0.0);
+    }
+};
+
+// Admissibility limits for alternative routes, relative to the optimal weight
+struct AlternativeOptions {
+    size_t maxAlternatives = 2;
+    double maxStretch = 0.25;        // alternative may be at most 25% longer
+    double maxSharing = 0.8;         // at most 80% shared with any route already chosen
+    double localOptimality = 0.25;   // every sub-path this long must itself be a shortest path
+};
+
+enum class SimplifyMethod {
+    DouglasPeucker,  // drop points closer than the tolerance to the simplified line
+    Visvalingam      // drop points whose triangle with their neighbours is smaller than tolerance²
+};
+
+// Geometry simplification of a returned path
+struct SimplifyOptions {
+    SimplifyMethod method = SimplifyMethod::DouglasPeucker;
+    double tolerance = 0.0;  // metres
+};
+
+/**
+ * Ground size of one screen pixel on a Web Mercator map with 512 pixel tiles
+ * (the zoom levels used by the frontend's map)
+ * @return Metres per pixel at the given latitude
+ */
+double pixelSizeAtZoom(double zoom, double latitude);
+
 class Graph {
 private:
     // Node storage: id -> {latitude, longitude}
     std::unordered_map<int64_t, std::pair<double, double>> nodes;
     
-    // Edge storage: source_id -> vector of {destination_id, distance}
-    std::unordered_map<int64_t, std::vector<std::pair<int64_t, double>>> edges;
-    
-    // Distance cache: {node1_id, node2_id} -> distance
-    std::unordered_map<std::pair<int64_t, int64_t>, double, PairHash> distanceCache;
+    // Edge storage: source_id -> vector of {destination_id, distance, id, profile, bearings}
+    std::unordered_map<int64_t, std::vector<Edge>> edges;
+
+    // Per-weighting edge weights indexed by Edge::id
+    std::array<std::vector<float>, WEIGHTING_COUNT> weights;
+    // Lowest weight per metre of each weighting, keeps the A* heuristic admissible
+    std::array<double, WEIGHTING_COUNT> minWeightPerMeter{};
+
+    // Shared congestion profiles referenced by Edge::profile
+    std::vector<TravelTimeProfile> profiles;
+    std::unordered_map<std::string, uint16_t> profileByHighway;
+    double minMultiplier = 0.0;
 
     // Private helper methods
     double haversineDistance(double lat1, double lon1, double lat2, double lon2) const;
+    static double bearing(const std::pair<double, double>& from, const std::pair<double, double>& to);
     double calculateAngle(const std::pair<double, double>& prev, const std::pair<double, double>& curr, const std::pair<double, double>& next, double prevAngle) const;
     double heuristic(int64_t node, int64_t goal) const;
+    struct WayAttributes {
+        uint16_t profile;
+        double carKmh;   // 0 when cars may not use the way
+        double bikeKmh;  // 0 when bikes may not use the way
+        int oneway;      // 1 forward only, -1 backward only, 0 both
+    };
+    WayAttributes parseWay(const json& way) const;
+    std::vector<json> reconstructPath(int64_t startId, int64_t endId,
+                                      const std::pmr::unordered_map<int64_t, int64_t>& prev,
+                                      const std::pmr::unordered_map<int64_t, double>* arrival = nullptr) const;
+    std::vector<json> buildPath(const std::vector<int64_t>& sequence,
+                                const std::pmr::unordered_map<int64_t, double>* arrival = nullptr) const;
 
 public:
+    static constexpr uint16_t DEFAULT_PROFILE = 0;
+
+    // Accepted isochrone raster cell sizes, and the most cells one outline may cover
+    static constexpr double MIN_ISOCHRONE_CELL_METERS = 5.0;
+    static constexpr double MAX_ISOCHRONE_CELL_METERS = 1000.0;
+    static constexpr long MAX_ISOCHRONE_CELLS = 4'000'000;
+
     // Constructors
-    Graph() = default;
+    Graph();
     ~Graph() = default;
 
     // Disable copying to prevent accidental copies of large graphs
@@ -51,17 +182,98 @@ public:
     Graph& operator=(Graph&&) = default;
 
     // Main interface methods
-    void loadFromJSON(const json& data);
-    std::vector<json> findPath(const json& start, const json& end);
+
+    /**
+     * Replace the graph with an Overpass response. Parsing, sorting, merging
+     * duplicate segments and filling the edge lists run on several threads;
+     * inserting ids into the node and edge maps stays serial.
+     * @param threads Worker threads; 0 uses all hardware threads
+     */
+    void loadFromJSON(const json& data, unsigned threads = 0);
+
+    /**
+     * A* over the static weights
+     * @param memory Resource for the search state, e.g. a RequestArena
+     * @return Path nodes, empty if unreachable
+     */
+    std::vector<json> findPath(const json& start, const json& end, Weighting weighting = Weighting::Distance,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    /**
+     * Time-dependent A* minimising car arrival time
+     * @param departureTime Departure as Unix timestamp in seconds
+     * @param utcOffset Offset in seconds added before taking the time of day
+     * @return Path nodes, each carrying its arrival "time"; empty if unreachable
+     */
+    std::vector<json> findPath(const json& start, const json& end, double departureTime, int utcOffset = 0,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    /**
+     * Edge-based A* over the lazily expanded line graph, charging turnCosts
+     * at every intersection; a node may appear twice if looping beats turning
+     * @return Path nodes, empty if unreachable
+     */
+    std::vector<json> findPath(const json& start, const json& end, const TurnCosts& turnCosts,
+                               Weighting weighting = Weighting::Distance,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    /**
+     * Optimal path plus via-node alternatives from one bidirectional search
+     * (see alternatives.cpp)
+     * @return Array of {"path", "weight", "sharing"}, optimal first; empty if unreachable
+     */
+    json findAlternatives(const json& start, const json& end, Weighting weighting = Weighting::Distance,
+                          const AlternativeOptions& options = {}) const;
+
+    /**
+     * K shortest loopless paths (Yen) with the reverse shortest-path tree as
+     * an exact heuristic for spur searches (see kshortest.cpp)
+     * @param threads Spur searches run in parallel; 0 uses all hardware threads
+     * @return Array of {"path", "weight"} in increasing weight; empty if unreachable
+     */
+    json kShortestPaths(const json& start, const json& end, size_t k, Weighting weighting = Weighting::Distance,
+                        unsigned threads = 0) const;
+
+    /**
+     * Drop path points that would not be visible at the given tolerance (see simplify.cpp).
+     * Kept points keep their id and time; distance still covers the road back to the
+     * previous kept point and angle is recomputed from the kept points.
+     * @param path Output of findPath, first and last point are always kept
+     */
+    std::vector<json> simplifyPath(const std::vector<json>& path, const SimplifyOptions& options) const;
+
+    /**
+     * Bounded one-to-all search from a node (see isochrone.cpp)
+     * @param start JSON node with an "id"
+     * @param budget Limit in the weighting's units (metres or seconds)
+     * @param cellSizeMeters Raster cell size for the outline polygon, between MIN_ISOCHRONE_CELL_METERS
+     *                       and MAX_ISOCHRONE_CELL_METERS; 0 skips the polygon
+     * @throws std::invalid_argument for any other cell size, or an outline over MAX_ISOCHRONE_CELLS cells
+     * @return {"reached": [...], "boundary": [...], "polygon": GeoJSON Polygon or null}
+     */
+    json isochrone(const json& start, double budget, Weighting weighting, double cellSizeMeters = 0.0) const;
+
+    // Profile table management
+    uint16_t addProfile(TravelTimeProfile profile);
+    void assignHighwayProfile(const std::string& highway, uint16_t profileId);
+    const std::vector<TravelTimeProfile>& getProfiles() const { return profiles; }
+
+    double getWeight(Weighting weighting, const Edge& edge) const {
+        return weights[static_cast<size_t>(weighting)][edge.id];
+    }
     json getPathState() const;
 
     // Utility methods
     void clear() {
         nodes.clear();
         edges.clear();
-        distanceCache.clear();
+        for (auto& array : weights) array.clear();
     }
 
+    // Read-only views for engines that build their own layouts (e.g. PhastEngine)
+    const std::unordered_map<int64_t, std::pair<double, double>>& getNodes() const { return nodes; }
+    const std::unordered_map<int64_t, std::vector<Edge>>& getEdges() const { return edges; }
+
     size_t getNodeCount() const { return nodes.size(); }
     size_t getEdgeCount() const { return edges.size(); }
     
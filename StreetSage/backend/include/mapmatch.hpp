@@ -0,0 +1,133 @@
+#ifndef MAPMATCH_HPP
+#define MAPMATCH_HPP
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "graph.hpp"
+
+// HMM map matching (Newson & Krumm) over a snapshot of a loaded Graph.
+//
+// Candidates for a GPS point are projections onto nearby directed edges,
+// found through a uniform grid over the segments. Emissions are Gaussian in
+// the projection distance, transitions exponential in the difference between
+// route and great-circle distance, with route distances from bounded
+// one-to-many Dijkstras. A Session runs an online Viterbi and emits points as
+// soon as all surviving hypotheses agree on them.
+class MapMatcher {
+public:
+    struct Options {
+        double gpsSigma = 10.0;        // GPS noise, metres
+        double beta = 5.0;             // transition scale, metres
+        double searchRadius = 50.0;    // candidate radius around each point, metres
+        size_t maxCandidates = 8;      // nearest candidates kept per point
+        double maxRouteFactor = 2.0;   // route searches stop at this multiple of the straight distance
+    };
+
+    struct MatchedPoint {
+        size_t index;        // position in the trace
+        bool matched;        // false for points without candidates or after a break
+        int64_t from = 0;    // matched directed edge
+        int64_t to = 0;
+        double fraction = 0.0;
+        double lat = 0.0;    // snapped position
+        double lon = 0.0;
+        double error = 0.0;  // distance between the GPS fix and the snapped position
+    };
+
+    /**
+     * Snapshot the graph and index its segments
+     * @param weighting Edges with an infinite weight (e.g. against a oneway) are never matched
+     */
+    MapMatcher(const Graph& graph, Weighting weighting, Options options);
+    explicit MapMatcher(const Graph& graph, Weighting weighting = Weighting::CarTime)
+        : MapMatcher(graph, weighting, Options{}) {}
+
+    // Incremental matcher for one trace; not thread-safe, but sessions are independent
+    class Session {
+    public:
+        explicit Session(const MapMatcher& matcher) : matcher(matcher) {}
+
+        /**
+         * Add the next GPS fix
+         * @return Points whose match became final, in trace order
+         */
+        std::vector<MatchedPoint> push(double lat, double lon);
+
+        // Decide all remaining points
+        std::vector<MatchedPoint> finish();
+
+    private:
+        struct State {
+            uint32_t edge;
+            double fraction;
+            double error;
+            double score;
+            int32_t back;  // index into the previous column, -1 at the start of a run
+        };
+        struct Column {
+            size_t index;
+            std::vector<State> states;
+            std::vector<size_t> skipped;  // later points without candidates, reported after this one
+        };
+        struct RouteSearch {
+            double limit;
+            std::unordered_map<uint32_t, double> dist;
+        };
+
+        const MapMatcher& matcher;
+        std::deque<Column> lattice;  // undecided columns of the current run
+        size_t nextIndex = 0;
+        size_t emitted = 0;          // columns at the front of lattice that were already emitted
+        double lastX = 0.0, lastY = 0.0;
+
+        // One-to-many searches by source node, kept for one step since
+        // consecutive fixes usually start from the same edges
+        std::unordered_map<uint32_t, RouteSearch> searches;
+        std::unordered_map<uint32_t, RouteSearch> previousSearches;
+
+        const std::unordered_map<uint32_t, double>& search(uint32_t source, double limit);
+        std::vector<MatchedPoint> decide(size_t upTo, int32_t state);
+        std::vector<MatchedPoint> flush();
+    };
+
+    /**
+     * Match a whole trace of {lat, lon} objects
+     * @return One entry per input point
+     */
+    std::vector<MatchedPoint> match(const json& trace) const;
+
+private:
+    Options options;
+
+    // Dense snapshot: nodes, directed edges by Edge::id, outgoing edges per node
+    std::vector<int64_t> nodeIds;
+    std::vector<double> nodeX, nodeY;  // local metric projection
+    std::vector<uint32_t> edgeFrom, edgeTo;
+    std::vector<float> edgeLength;
+    std::vector<bool> edgeAllowed;
+    std::vector<uint32_t> outOffsets, outEdges;
+
+    // Projection around the graph's centre
+    double originLat = 0.0, originLon = 0.0;
+    double metersPerDegLat = 110540.0, metersPerDegLon = 111320.0;
+
+    // Uniform grid over segments (edge id / 2), cell size = searchRadius
+    std::unordered_map<int64_t, std::pair<uint32_t, uint32_t>> cells;  // cell -> range in cellSegments
+    std::vector<uint32_t> cellSegments;
+
+    void project(double lat, double lon, double& x, double& y) const;
+    void unproject(double x, double y, double& lat, double& lon) const;
+    int64_t cellKey(long cx, long cy) const { return (static_cast<int64_t>(cx) << 32) ^ static_cast<uint32_t>(cy); }
+
+    struct Candidate {
+        uint32_t edge;
+        double fraction;
+        double error;
+    };
+    std::vector<Candidate> candidates(double x, double y) const;
+    MatchedPoint toMatched(size_t index, uint32_t edge, double fraction, double error) const;
+};
+
+#endif // MAPMATCH_HPP
@@ -0,0 +1,72 @@
+#ifndef PHAST_HPP
+#define PHAST_HPP
+
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "graph.hpp"
+
+// One-to-all shortest paths with PHAST (Delling et al.).
+//
+// Construction contracts the graph into a node-ordered hierarchy. A query is
+// a short Dijkstra over upward edges from the source followed by one linear
+// sweep over all nodes in decreasing rank, relaxing downward edges that are
+// stored grouped by target in sweep order. The sweep touches memory almost
+// sequentially, and the multi-source variant runs LANES sources side by side
+// so the inner min/add loop vectorises.
+class PhastEngine {
+public:
+    static constexpr int LANES = 8;
+
+    /**
+     * Build the hierarchy for one weighting of a loaded graph
+     * @param graph Loaded graph; the engine copies what it needs
+     * @param weighting Weight array to use, infinite weights are dropped
+     */
+    PhastEngine(const Graph& graph, Weighting weighting);
+
+    // OSM node ids in the order used by all distance arrays
+    const std::vector<int64_t>& getNodeIds() const { return nodeIds; }
+    size_t getShortcutCount() const { return shortcutCount; }
+
+    /**
+     * Distances from one source to every node
+     * @throws std::out_of_range if the source is not in the graph
+     */
+    std::vector<float> distancesFrom(int64_t source) const;
+
+    /**
+     * Distances from many sources, processed LANES at a time
+     * @return One array per source, in getNodeIds() order
+     * @throws std::out_of_range if a source is not in the graph
+     */
+    std::vector<std::vector<float>> distancesFrom(const std::vector<int64_t>& sources) const;
+
+private:
+    std::vector<int64_t> nodeIds;                  // dense index -> OSM id
+    std::unordered_map<int64_t, uint32_t> indexOf; // OSM id -> dense index
+    std::vector<uint32_t> position;                // dense index -> sweep position (rank descending)
+
+    // Upward edges by sweep position of their tail
+    std::vector<uint32_t> upOffsets;
+    std::vector<uint32_t> upTargets;
+    std::vector<float> upWeights;
+
+    // Downward edges by sweep position of their head; sources always precede the head
+    std::vector<uint32_t> downOffsets;
+    std::vector<uint32_t> downSources;
+    std::vector<float> downWeights;
+
+    size_t shortcutCount = 0;
+
+    void contract(std::vector<std::vector<std::pair<uint32_t, float>>>& out,
+                  std::vector<std::vector<std::pair<uint32_t, float>>>& in,
+                  std::vector<uint32_t>& rank,
+                  std::vector<std::tuple<uint32_t, uint32_t, float>>& allEdges);
+
+    template <int Lanes>
+    void sweep(const std::vector<uint32_t>& sourcePositions, std::vector<float>& dist) const;
+};
+
+#endif // PHAST_HPP
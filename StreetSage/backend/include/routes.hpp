@@ -5,8 +5,11 @@
 #include "crow.h"
 #include "crow/middlewares/cors.h"
 #include "graph.hpp"
+#include "api.hpp"
+#include "exploration.hpp"
 
 // Define route handlers
-void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph);
+void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph, AsyncOverpassFetcher& fetcher,
+                 ExplorationHub& explorations);
 
 #endif // ROUTES_HPP
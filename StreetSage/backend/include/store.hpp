@@ -0,0 +1,96 @@
+#ifndef OVERPASS_TILE_STORE_HPP
+#define OVERPASS_TILE_STORE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+struct BoundingBox;
+
+// Content-addressed on-disk cache of Overpass responses.
+//
+// Layout of the store directory:
+//   index.bin          header + fixed-size IndexEntry records, appended on every store
+//   records/<key>.z    zlib-compressed response body named by its key
+//
+// Records are keyed by the hash of the full query (normalized bbox plus the
+// highway exclusions), and the index also keeps each record's bbox and query
+// hash so that a request can be served by any fresh record covering it.
+// The latest entry per key is kept in memory. Refreshing a record appends a
+// new entry, so the file is rewritten with only the latest ones on open and
+// whenever it grows to COMPACT_FACTOR times their number. A torn entry left
+// at the end by a crash is cut off on open.
+class OverpassTileStore {
+public:
+    struct Options {
+        int64_t maxAgeSeconds = 7 * 24 * 3600;  // older records are refreshed upstream
+        bool offline = false;                   // never go upstream, e.g. for fixtures
+    };
+
+    struct Record {
+        std::string data;
+        bool fresh;
+    };
+
+    /**
+     * Open (or create) a store directory and load its index
+     * @param directory Store location; created if missing
+     * @throws std::runtime_error if the directory or index cannot be opened
+     */
+    OverpassTileStore(const std::string& directory, Options options);
+    ~OverpassTileStore();
+
+    OverpassTileStore(const OverpassTileStore&) = delete;
+    OverpassTileStore& operator=(const OverpassTileStore&) = delete;
+
+    /**
+     * Snap a bounding box outwards to the store grid so nearby requests share records
+     */
+    static BoundingBox normalize(const BoundingBox& boundingBox);
+
+    /**
+     * Find the newest record covering a bounding box for the given query
+     * @return The decompressed response and whether it is within maxAgeSeconds
+     */
+    std::optional<Record> find(const BoundingBox& boundingBox, uint64_t queryHash) const;
+
+    /**
+     * Compress and persist a response fetched for a (normalized) bounding box
+     */
+    void store(const BoundingBox& boundingBox, uint64_t queryHash, const std::string& data);
+
+    bool isOffline() const { return options.offline; }
+
+    static uint64_t hash(const std::string& data);
+
+private:
+    struct IndexEntry {
+        uint64_t key;
+        uint64_t queryHash;
+        double minLat, minLon, maxLat, maxLon;
+        int64_t fetchedAt;
+        uint32_t rawSize;
+        uint32_t compressedSize;
+    };
+
+    static constexpr double GRID_DEGREES = 0.01;
+    static constexpr size_t COMPACT_FACTOR = 2;
+    static constexpr size_t MIN_COMPACT_ENTRIES = 64;  // smaller files are left alone
+
+    std::string directory;
+    Options options;
+    int indexFd = -1;                                // opened for appending
+    std::unordered_map<uint64_t, IndexEntry> live;  // latest entry per key
+    size_t appended = 0;                             // entries in index.bin
+    mutable std::shared_mutex mutex;
+
+    void load();
+    void compact();
+    std::string indexPath() const { return directory + "/index.bin"; }
+    std::string recordPath(uint64_t key) const;
+    std::optional<std::string> readRecord(const IndexEntry& entry) const;
+};
+
+#endif // OVERPASS_TILE_STORE_HPP
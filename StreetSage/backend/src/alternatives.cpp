@@ -0,0 +1,297 @@
+#include "graph.hpp"
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+// Candidates are checked best score first; later ones rarely pass the filters
+constexpr size_t MAX_CANDIDATE_CHECKS = 64;
+
+using QueueEntry = std::pair<double, int64_t>;
+using MinQueue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+// One direction of the bidirectional search. Settled labels are final; the
+// tree is kept after the search so candidate paths can be read back from it.
+struct SearchTree {
+    std::unordered_map<int64_t, double> dist;
+    std::unordered_map<int64_t, int64_t> parent;
+    std::unordered_set<int64_t> settled;
+    MinQueue queue;
+
+    double get(int64_t node) const {
+        auto it = dist.find(node);
+        return it == dist.end() ? INF : it->second;
+    }
+    double minKey() const { return queue.empty() ? INF : queue.top().first; }
+};
+
+// A candidate route through a via node, stored as its node sequence
+struct Candidate {
+    int64_t via;
+    double weight;
+    double plateau;
+    std::vector<int64_t> sequence;
+    std::vector<double> prefix;  // weight from the start up to each node of sequence
+};
+
+using SegmentSet = std::unordered_map<std::pair<int64_t, int64_t>, double, PairHash>;
+
+SegmentSet segments(const Candidate& route) {
+    SegmentSet result;
+    for (size_t i = 0; i + 1 < route.sequence.size(); ++i) {
+        result[{route.sequence[i], route.sequence[i + 1]}] = route.prefix[i + 1] - route.prefix[i];
+    }
+    return result;
+}
+
+double sharedWeight(const Candidate& route, const SegmentSet& other) {
+    double shared = 0.0;
+    for (size_t i = 0; i + 1 < route.sequence.size(); ++i) {
+        if (other.count({route.sequence[i], route.sequence[i + 1]})) {
+            shared += route.prefix[i + 1] - route.prefix[i];
+        }
+    }
+    return shared;
+}
+
+} // namespace
+
+json Graph::findAlternatives(const json& start, const json& end, Weighting weighting,
+                             const AlternativeOptions& options) const {
+    if (!nodes.count(start["id"]) || !nodes.count(end["id"])) {
+        return json::array();
+    }
+    const int64_t startId = start["id"];
+    const int64_t endId = end["id"];
+    const auto& weight = weights[static_cast<size_t>(weighting)];
+
+    // Bidirectional Dijkstra. The backward search walks edges in reverse: an
+    // edge u -> v is found from v as the twin (id ^ 1) of v's edge to u.
+    SearchTree forward, backward;
+    forward.dist[startId] = 0.0;
+    forward.queue.push({0.0, startId});
+    backward.dist[endId] = 0.0;
+    backward.queue.push({0.0, endId});
+
+    double best = INF;
+    int64_t meeting = -1;
+    auto step = [&](SearchTree& tree, const SearchTree& other, bool reverse) {
+        auto [d, node] = tree.queue.top();
+        tree.queue.pop();
+        if (d > tree.get(node) || !tree.settled.insert(node).second) return;
+
+        const double through = d + other.get(node);
+        if (through < best) {
+            best = through;
+            meeting = node;
+        }
+
+        auto it = edges.find(node);
+        if (it == edges.end()) return;
+        for (const auto& edge : it->second) {
+            const double w = weight[reverse ? edge.id ^ 1 : edge.id];
+            if (std::isinf(w)) continue;
+            const double next = d + w;
+            auto [slot, inserted] = tree.dist.try_emplace(edge.to, next);
+            if (inserted || next < slot->second) {
+                slot->second = next;
+                tree.parent[edge.to] = node;
+                tree.queue.push({next, edge.to});
+            }
+        }
+    };
+
+    // Keep both searches going past the meeting point until every via node
+    // within the stretch limit has been settled from both sides
+    const double stretch = 1.0 + options.maxStretch;
+    while (!forward.queue.empty() || !backward.queue.empty()) {
+        const double limit = std::isinf(best) ? INF : best * stretch;
+        const bool forwardDone = forward.minKey() > limit;
+        const bool backwardDone = backward.minKey() > limit;
+        if (forwardDone && backwardDone) break;
+        if (!forwardDone && (backwardDone || forward.minKey() <= backward.minKey())) {
+            step(forward, backward, false);
+        } else {
+            step(backward, forward, true);
+        }
+    }
+    if (meeting < 0) return json::array();
+
+    // Path through a via node: forward tree to it, backward tree from it
+    auto throughVia = [&](int64_t via, double plateau) {
+        Candidate route{via, forward.get(via) + backward.get(via), plateau, {}, {}};
+        for (int64_t at = via; ; at = forward.parent.at(at)) {
+            route.sequence.push_back(at);
+            route.prefix.push_back(forward.get(at));
+            if (at == startId) break;
+        }
+        std::reverse(route.sequence.begin(), route.sequence.end());
+        std::reverse(route.prefix.begin(), route.prefix.end());
+        for (int64_t at = via; at != endId; ) {
+            at = backward.parent.at(at);
+            route.sequence.push_back(at);
+            route.prefix.push_back(route.weight - backward.get(at));
+        }
+        return route;
+    };
+
+    // Plateaus: maximal chains where both trees use the same edge. A via node
+    // on a long plateau yields a route that is locally optimal along it.
+    std::unordered_map<int64_t, int64_t> plateauNext;
+    std::unordered_set<int64_t> hasPlateauPrev;
+    for (int64_t node : forward.settled) {
+        if (!backward.settled.count(node) || node == endId) continue;
+        auto it = backward.parent.find(node);
+        if (it == backward.parent.end()) continue;
+        auto next = forward.parent.find(it->second);
+        if (next != forward.parent.end() && next->second == node) {
+            plateauNext[node] = it->second;
+            hasPlateauPrev.insert(it->second);
+        }
+    }
+
+    // One candidate per plateau (its first node) plus every isolated via node
+    std::vector<std::pair<int64_t, double>> vias;
+    std::unordered_set<int64_t> onPlateau;
+    for (const auto& [head, _] : plateauNext) {
+        if (hasPlateauPrev.count(head)) continue;
+        double length = 0.0;
+        for (int64_t at = head; plateauNext.count(at); at = plateauNext.at(at)) {
+            const int64_t next = plateauNext.at(at);
+            length += forward.get(next) - forward.get(at);
+            onPlateau.insert(at);
+            onPlateau.insert(next);
+        }
+        vias.emplace_back(head, length);
+    }
+    for (int64_t node : forward.settled) {
+        if (backward.settled.count(node) && !onPlateau.count(node)) vias.emplace_back(node, 0.0);
+    }
+
+    const Candidate optimal = throughVia(meeting, 0.0);
+    const SegmentSet optimalSegments = segments(optimal);
+    const size_t meetingIndex = std::find(optimal.sequence.begin(), optimal.sequence.end(), meeting)
+        - optimal.sequence.begin();
+    const std::unordered_set<int64_t> optimalHead(optimal.sequence.begin(), optimal.sequence.begin() + meetingIndex + 1);
+    const std::unordered_set<int64_t> optimalTail(optimal.sequence.begin() + meetingIndex, optimal.sequence.end());
+
+    // Weight a tree path shares with the optimal route: the optimal route is
+    // itself a path in each tree, so sharing ends where the tree path leaves
+    // it. Memoised per node so all candidates cost linear time together.
+    auto sharedPrefix = [](const SearchTree& tree, const std::unordered_set<int64_t>& onOptimal,
+                           std::unordered_map<int64_t, double>& memo, int64_t node) {
+        std::vector<int64_t> walk;
+        double shared = 0.0;
+        for (int64_t at = node; ; at = tree.parent.at(at)) {
+            auto it = memo.find(at);
+            if (it != memo.end()) { shared = it->second; break; }
+            if (onOptimal.count(at)) { shared = tree.get(at); break; }
+            walk.push_back(at);
+        }
+        for (int64_t at : walk) memo[at] = shared;
+        return shared;
+    };
+    std::unordered_map<int64_t, double> forwardShared, backwardShared;
+
+    // Cheap filters first: stretch, and whether the via node lies on the optimal route
+    struct Via {
+        int64_t node;
+        double weight;
+        double plateau;
+        double sharing;
+    };
+    std::vector<Via> candidates;
+    for (const auto& [via, plateau] : vias) {
+        const double length = forward.get(via) + backward.get(via);
+        if (length > best * stretch || optimalHead.count(via) || optimalTail.count(via)) continue;
+        const double sharing = sharedPrefix(forward, optimalHead, forwardShared, via) +
+                               sharedPrefix(backward, optimalTail, backwardShared, via);
+        if (sharing > options.maxSharing * best) continue;
+        candidates.push_back({via, length, plateau, sharing});
+    }
+
+    // Prefer short, distinct routes with long plateaus (Abraham et al.)
+    std::sort(candidates.begin(), candidates.end(), [](const Via& a, const Via& b) {
+        return 2 * a.weight + a.sharing - a.plateau < 2 * b.weight + b.sharing - b.plateau;
+    });
+
+    // T-test: the sub-path spanning localOptimality * best around the via node
+    // must be a shortest path between its ends
+    auto locallyOptimal = [&](const Candidate& route) {
+        const double window = options.localOptimality * best;
+        if (route.plateau >= window) return true;
+
+        const size_t viaIndex = std::find(route.sequence.begin(), route.sequence.end(), route.via)
+            - route.sequence.begin();
+        size_t from = viaIndex, to = viaIndex;
+        while (from > 0 && route.prefix[viaIndex] - route.prefix[from] < window) --from;
+        while (to + 1 < route.sequence.size() && route.prefix[to] - route.prefix[viaIndex] < window) ++to;
+        const double span = route.prefix[to] - route.prefix[from];
+        const int64_t source = route.sequence[from];
+        const int64_t target = route.sequence[to];
+
+        // A* between the ends, pruned at the route's own weight
+        const double rate = minWeightPerMeter[static_cast<size_t>(weighting)];
+        const double bound = span * (1 - 1e-6);
+        std::unordered_map<int64_t, double> dist = {{source, 0.0}};
+        MinQueue queue;
+        queue.push({heuristic(source, target) * rate, source});
+        while (!queue.empty()) {
+            const int64_t node = queue.top().second;
+            queue.pop();
+            const double d = dist.at(node);
+            if (node == target) return d >= bound;
+            auto it = edges.find(node);
+            if (it == edges.end()) continue;
+            for (const auto& edge : it->second) {
+                const double next = d + weight[edge.id];
+                const double estimate = next + heuristic(edge.to, target) * rate;
+                if (estimate >= bound) continue;
+                auto [slot, inserted] = dist.try_emplace(edge.to, next);
+                if (inserted || next < slot->second) {
+                    slot->second = next;
+                    queue.push({estimate, edge.to});
+                }
+            }
+        }
+        return true;
+    };
+
+    std::vector<Candidate> chosen = {optimal};
+    std::vector<SegmentSet> chosenSegments = {optimalSegments};
+    size_t checked = 0;
+    for (const auto& via : candidates) {
+        if (chosen.size() > options.maxAlternatives || checked++ >= MAX_CANDIDATE_CHECKS) break;
+        const Candidate route = throughVia(via.node, via.plateau);
+
+        // Tree paths from both sides can cross; such a route contains a loop
+        std::unordered_set<int64_t> visited(route.sequence.begin(), route.sequence.end());
+        if (visited.size() != route.sequence.size()) continue;
+
+        bool distinct = true;
+        for (const auto& other : chosenSegments) {
+            if (sharedWeight(route, other) > options.maxSharing * best) {
+                distinct = false;
+                break;
+            }
+        }
+        if (!distinct || !locallyOptimal(route)) continue;
+
+        chosen.push_back(route);
+        chosenSegments.push_back(segments(route));
+    }
+
+    json result = json::array();
+    for (const auto& route : chosen) {
+        const double shared = sharedWeight(route, optimalSegments);
+        result.push_back({
+            {"path", buildPath(route.sequence)},
+            {"weight", route.weight},
+            {"sharing", route.weight > 0 ? shared / route.weight : 1.0}
+        });
+    }
+    return result;
+}
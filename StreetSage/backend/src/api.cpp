@@ -1,12 +1,17 @@
 #include "api.hpp"
+#include "store.hpp"
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
+#include <optional>
+#include <async_log/log.hpp>
 
 const std::vector<std::string> OverpassDataFetcher::highWayExclude = {
     "footway", "street_lamp", "steps", "pedestrian", "track", "path"
 };
 
+std::shared_ptr<OverpassTileStore> OverpassDataFetcher::tileStore;
+
 // GeoPoint implementations
 double GeoPoint::calculateDistance(const GeoPoint& p1, const GeoPoint& p2) {
     const double R = 6371.0; // Earth's radius in kilometers
@@ -58,29 +63,195 @@ std::string OverpassDataFetcher::constructOverpassQuery(const BoundingBox& bound
         exclusionStream << "[highway!=\"" << exclude << "\"]";
     }
 
+    // Ways are printed with their tags (highway, maxspeed and oneway drive the
+    // weightings); Overpass cannot project single tags without dropping the
+    // node list, so trimming happens at ingestion. Nodes stay skeletons.
     std::stringstream queryStream;
-    queryStream << "[out:json];("
+    queryStream << "[out:json];"
                 << "way[highway]" << exclusionStream.str() << "[footway!=\"*\"]"
                 << "(" 
                 << boundingBox.min_lat << "," 
                 << boundingBox.min_lon << "," 
                 << boundingBox.max_lat << "," 
                 << boundingBox.max_lon 
-                << ");"
-                << "node(w);"
-                << ");out skel;";
+                << ")->.ways;"
+                << ".ways out body;"
+                << "node(w.ways);"
+                << "out skel;";
 
     return queryStream.str();
 }
 
+// Hash of everything in the query except the bounding box, so cached
+// responses are invalidated when highWayExclude or the output format change
+uint64_t OverpassDataFetcher::queryHash() {
+    static const uint64_t hash = OverpassTileStore::hash(constructOverpassQuery(BoundingBox{0, 0, 0, 0}));
+    return hash;
+}
+
+void OverpassDataFetcher::setTileStore(std::shared_ptr<OverpassTileStore> store) {
+    tileStore = std::move(store);
+}
+
 cpr::Response OverpassDataFetcher::fetchOverpassData(const BoundingBox& boundingBox) {
-    std::string query = constructOverpassQuery(boundingBox);
+    std::shared_ptr<OverpassTileStore> store = tileStore;
+    std::optional<OverpassTileStore::Record> cached;
+    if (store) {
+        cached = store->find(boundingBox, queryHash());
+        if (cached && (cached->fresh || store->isOffline())) {
+            cpr::Response response;
+            response.status_code = 200;
+            response.text = std::move(cached->data);
+            return response;
+        }
+        if (store->isOffline()) {
+            cpr::Response response;
+            response.status_code = 503;
+            response.text = "Bounding box not present in offline tile store";
+            return response;
+        }
+    }
+
+    // Fetch the grid-aligned box so the stored record also serves nearby requests
+    const BoundingBox fetchBox = store ? OverpassTileStore::normalize(boundingBox) : boundingBox;
+    std::string query = constructOverpassQuery(fetchBox);
     
-    return cpr::Post(
+    cpr::Response response = cpr::Post(
         cpr::Url{"https://overpass-api.de/api/interpreter"},
         cpr::Body{query},
         cpr::Timeout{30000} // 30 second timeout
     );
+
+    if (store) {
+        if (response.status_code == 200) {
+            try {
+                store->store(fetchBox, queryHash(), response.text);
+            } catch (const std::exception& e) {
+                async_log::warn("Tile store write failed", {{"error", e.what()}});
+            }
+        } else if (cached) {
+            // Serve the stale record rather than failing when upstream is unavailable
+            async_log::warn("Overpass API error, serving stale tile", {{"status", response.status_code}});
+            response.status_code = 200;
+            response.text = std::move(cached->data);
+        }
+    }
+    return response;
+}
+
+// AsyncOverpassFetcher implementations
+AsyncOverpassFetcher::AsyncOverpassFetcher(size_t threads, size_t computeThreads, size_t maxFlights,
+                                           size_t maxWaiters)
+    : maxFlights(maxFlights), maxWaiters(maxWaiters) {
+    threads = std::max<size_t>(threads, 1);
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&AsyncOverpassFetcher::run, this);
+    }
+    computeThreads = std::max<size_t>(computeThreads, 1);
+    computeWorkers.reserve(computeThreads);
+    for (size_t i = 0; i < computeThreads; ++i) {
+        computeWorkers.emplace_back(&AsyncOverpassFetcher::complete, this);
+    }
+}
+
+AsyncOverpassFetcher::~AsyncOverpassFetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The I/O threads have handed over every callback by now
+    {
+        std::lock_guard<std::mutex> lock(computeMutex);
+        computeStopping = true;
+    }
+    computeReady.notify_all();
+    for (auto& worker : computeWorkers) {
+        worker.join();
+    }
+}
+
+bool AsyncOverpassFetcher::fetch(const BoundingBox& boundingBox, Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || waiting >= maxWaiters) return false;
+        for (auto& flight : flights) {
+            if (flight->boundingBox.contains(boundingBox)) {
+                flight->waiters.push_back(std::move(callback));
+                ++waiting;
+                return true;
+            }
+        }
+        if (flights.size() >= maxFlights) return false;
+
+        ++waiting;
+        auto flight = std::make_shared<Flight>();
+        flight->boundingBox = boundingBox;
+        flight->waiters.push_back(std::move(callback));
+        flights.push_back(flight);
+        pending.push_back(std::move(flight));
+    }
+    ready.notify_one();
+    return true;
+}
+
+void AsyncOverpassFetcher::run() {
+    for (;;) {
+        std::shared_ptr<Flight> flight;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (stopping && pending.empty()) return;
+            flight = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        auto response = std::make_shared<const cpr::Response>(
+            OverpassDataFetcher::fetchOverpassData(flight->boundingBox));
+
+        // Detach the flight before fanning out so late requests start a fresh fetch
+        std::vector<Callback> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flights.erase(std::find(flights.begin(), flights.end(), flight));
+            waiters = std::move(flight->waiters);
+        }
+
+        // Only hand the callbacks over; parsing and searching happen on the compute pool
+        {
+            std::lock_guard<std::mutex> lock(computeMutex);
+            for (auto& waiter : waiters) {
+                completions.push_back([waiter = std::move(waiter), response] { waiter(*response); });
+            }
+        }
+        computeReady.notify_all();
+    }
+}
+
+void AsyncOverpassFetcher::complete() {
+    for (;;) {
+        std::function<void()> completion;
+        {
+            std::unique_lock<std::mutex> lock(computeMutex);
+            computeReady.wait(lock, [this] { return computeStopping || !completions.empty(); });
+            if (computeStopping && completions.empty()) return;
+            completion = std::move(completions.front());
+            completions.pop_front();
+        }
+
+        try {
+            completion();
+        } catch (const std::exception& e) {
+            async_log::error("Overpass callback error", {{"error", e.what()}});
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        --waiting;
+    }
 }
 
 // BoundingBoxGenerator implementations
@@ -160,4 +331,22 @@ BoundingBox BoundingBoxGenerator::getBoundingBox() const {
     }
 
     return bbox;
-}
\ No newline at end of file
+}
+
+BoundingBox BoundingBoxGenerator::around(const json& center, double radiusKm) {
+    GeoPoint point;
+    try {
+        point = {center.at("lat").get<double>(), center.at("lon").get<double>()};
+    } catch (const json::exception& e) {
+        throw std::invalid_argument("Invalid JSON format for coordinates");
+    }
+    if (point.lat < -90 || point.lat > 90 || point.lon < -180 || point.lon > 180) {
+        throw std::invalid_argument("Coordinates out of valid range");
+    }
+
+    const GeoPoint north = point.destinationPoint(radiusKm, 0);
+    const GeoPoint east = point.destinationPoint(radiusKm, M_PI / 2);
+    const GeoPoint south = point.destinationPoint(radiusKm, M_PI);
+    const GeoPoint west = point.destinationPoint(radiusKm, 3 * M_PI / 2);
+    return BoundingBox{south.lat, west.lon, north.lat, east.lon};
+}
@@ -0,0 +1,61 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+constexpr size_t INITIAL_BLOCK_SIZE = 1 << 20;
+// Requests larger than this keep spilling instead of pinning memory per thread
+constexpr size_t MAX_BLOCK_SIZE = 64 << 20;
+
+struct ThreadBlock {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+    bool inUse = false;
+};
+
+thread_local ThreadBlock block;
+
+} // namespace
+
+void* RequestArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void RequestArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool RequestArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+RequestArena::RequestArena() {
+    // A nested arena on the same thread cannot share the block, so it
+    // allocates from the upstream resource only
+    if (block.inUse) {
+        buffer.emplace(&upstream);
+        return;
+    }
+    if (!block.data) {
+        block.data = std::make_unique<std::byte[]>(INITIAL_BLOCK_SIZE);
+        block.size = INITIAL_BLOCK_SIZE;
+    }
+    block.inUse = true;
+    ownsBlock = true;
+    buffer.emplace(block.data.get(), block.size, &upstream);
+}
+
+RequestArena::~RequestArena() {
+    buffer.reset();
+    if (!ownsBlock) return;
+
+    // Grow the block so the next request of this size fits without spilling
+    if (upstream.allocated > 0 && block.size < MAX_BLOCK_SIZE) {
+        const size_t wanted = std::min(MAX_BLOCK_SIZE, std::max(block.size * 2, block.size + upstream.allocated));
+        block.data = std::make_unique<std::byte[]>(wanted);
+        block.size = wanted;
+    }
+    block.inUse = false;
+}
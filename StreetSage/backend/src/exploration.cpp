@@ -0,0 +1,367 @@
+#include "exploration.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <shortest_path/layouts.hpp>
+#include <shortest_path/search.hpp>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+// Settled nodes between clock reads; reading it per node would dominate small searches
+constexpr size_t CLOCK_CHECK_INTERVAL = 64;
+
+enum FrameType : uint8_t {
+    BATCH = 1,
+    PATH = 2
+};
+
+// Same great-circle distance as Graph, so the heuristic stays admissible
+double haversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    const double R = 6371000;
+    const double phi1 = lat1 * M_PI / 180;
+    const double phi2 = lat2 * M_PI / 180;
+    const double deltaPhi = (lat2 - lat1) * M_PI / 180;
+    const double deltaLambda = (lon2 - lon1) * M_PI / 180;
+    const double a = std::sin(deltaPhi / 2) * std::sin(deltaPhi / 2) +
+                     std::cos(phi1) * std::cos(phi2) * std::sin(deltaLambda / 2) * std::sin(deltaLambda / 2);
+    return R * 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void putF64(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+}
+
+void putVarint(std::string& out, int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        out.push_back(static_cast<char>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back(static_cast<char>(zigzag));
+}
+
+std::string newRequestId() {
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    static const char* digits = "0123456789abcdef";
+    std::string id;
+    for (int part = 0; part < 2; ++part) {
+        uint64_t bits = rng();
+        for (int i = 0; i < 16; ++i, bits >>= 4) id.push_back(digits[bits & 0xf]);
+    }
+    return id;
+}
+
+} // namespace
+
+// Outgoing edges of one weighting in CSR form, forbidden edges left out
+struct ExplorationHub::Snapshot {
+    std::vector<double> lat, lon;
+    std::vector<uint32_t> offsets, targets;
+    std::vector<float> weights, lengths;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    double rate = 0.0;  // lowest weight per metre, scales the heuristic
+
+    Snapshot(const Graph& graph, int64_t startId, int64_t endId, Weighting weighting) {
+        const auto& graphNodes = graph.getNodes();
+        std::unordered_map<int64_t, uint32_t> indexOf;
+        indexOf.reserve(graphNodes.size());
+        for (const auto& [id, coords] : graphNodes) {
+            indexOf[id] = static_cast<uint32_t>(lat.size());
+            lat.push_back(coords.first);
+            lon.push_back(coords.second);
+        }
+        start = indexOf.at(startId);
+        end = indexOf.at(endId);
+
+        offsets.assign(lat.size() + 1, 0);
+        for (const auto& [src, edgeList] : graph.getEdges()) {
+            for (const auto& edge : edgeList) {
+                if (!std::isinf(graph.getWeight(weighting, edge))) ++offsets[indexOf.at(src) + 1];
+            }
+        }
+        for (size_t i = 0; i < lat.size(); ++i) offsets[i + 1] += offsets[i];
+        targets.resize(offsets.back());
+        weights.resize(offsets.back());
+        lengths.resize(offsets.back());
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        double lowest = INF;
+        for (const auto& [src, edgeList] : graph.getEdges()) {
+            const uint32_t u = indexOf.at(src);
+            for (const auto& edge : edgeList) {
+                const double w = graph.getWeight(weighting, edge);
+                if (std::isinf(w)) continue;
+                const uint32_t slot = cursor[u]++;
+                targets[slot] = indexOf.at(edge.to);
+                weights[slot] = static_cast<float>(w);
+                lengths[slot] = static_cast<float>(edge.distance);
+                if (edge.distance > 0) lowest = std::min(lowest, w / edge.distance);
+            }
+        }
+        rate = std::isinf(lowest) ? 0.0 : lowest;
+    }
+
+    double heuristic(uint32_t node) const {
+        return haversineDistance(lat[node], lon[node], lat[end], lon[end]) * rate;
+    }
+
+    // Coordinates of nodes in 1e-6 degrees, delta-encoded
+    void putCoordinates(std::string& out, const std::vector<uint32_t>& nodes) const {
+        int64_t lastLat = 0, lastLon = 0;
+        for (uint32_t node : nodes) {
+            const int64_t nodeLat = std::llround(lat[node] * 1e6);
+            const int64_t nodeLon = std::llround(lon[node] * 1e6);
+            putVarint(out, nodeLat - lastLat);
+            putVarint(out, nodeLon - lastLon);
+            lastLat = nodeLat;
+            lastLon = nodeLon;
+        }
+    }
+};
+
+struct ExplorationHub::Stream {
+    crow::websocket::connection* conn;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool open = true;    // cleared by onClose; conn must not be used afterwards
+    uint32_t sent = 0;   // frames sent, also the next sequence number
+    uint32_t acked = 0;  // frames acknowledged by the client
+    std::thread worker;
+};
+
+ExplorationHub::ExplorationHub(Options options) : options(options) {
+    if (options.window == 0 || options.maxBatch == 0) {
+        throw std::invalid_argument("Exploration window and batch size must be positive");
+    }
+}
+
+ExplorationHub::~ExplorationHub() {
+    std::unordered_map<crow::websocket::connection*, std::shared_ptr<Stream>> running;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running.swap(streams);
+    }
+    for (auto& [_, stream] : running) stop(*stream);
+}
+
+std::string ExplorationHub::prepare(const Graph& graph, int64_t start, int64_t end, Weighting weighting) {
+    const auto& nodes = graph.getNodes();
+    if (!nodes.count(start) || !nodes.count(end)) {
+        throw std::invalid_argument("Start or end node is not in the loaded graph");
+    }
+
+    // Drop searches nobody claimed before spending time on a new snapshot
+    auto full = [this] {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = pending.begin(); it != pending.end(); ) {
+            it = now - it->second.created > options.pendingTimeout ? pending.erase(it) : std::next(it);
+        }
+        return pending.size() + streams.size() >= options.maxExplorations;
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (full()) return {};
+    }
+
+    auto snapshot = std::make_shared<const Snapshot>(graph, start, end, weighting);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (full()) return {};
+    std::string id = newRequestId();
+    pending[id] = {std::move(snapshot), std::chrono::steady_clock::now()};
+    return id;
+}
+
+void ExplorationHub::onMessage(crow::websocket::connection& conn, const std::string& data) {
+    const json message = json::parse(data, nullptr, false);
+    if (message.is_discarded() || !message.is_object()) {
+        conn.close("Messages must be JSON objects");
+        return;
+    }
+
+    // Acknowledgement: opens the window for further frames
+    if (message.contains("ack")) {
+        std::shared_ptr<Stream> stream;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = streams.find(&conn);
+            if (it != streams.end()) stream = it->second;
+        }
+        if (!stream || !message["ack"].is_number_unsigned()) return;
+        const uint32_t sequence = message["ack"];
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (sequence < stream->sent) stream->acked = std::max(stream->acked, sequence + 1);
+        }
+        stream->wake.notify_all();
+        return;
+    }
+
+    // Claim: start streaming the parked search
+    if (!message.contains("request_id") || !message["request_id"].is_string()) {
+        conn.close("Expected a request_id or an ack");
+        return;
+    }
+    std::shared_ptr<const Snapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (streams.count(&conn)) return;
+        auto it = pending.find(message["request_id"].get<std::string>());
+        if (it != pending.end()) {
+            snapshot = std::move(it->second.snapshot);
+            pending.erase(it);
+        }
+    }
+    if (!snapshot) {
+        conn.close("Unknown or expired request_id");
+        return;
+    }
+
+    auto stream = std::make_shared<Stream>();
+    stream->conn = &conn;
+    stream->worker = std::thread([this, stream, snapshot] { run(*stream, *snapshot); });
+    std::lock_guard<std::mutex> lock(mutex);
+    streams[&conn] = std::move(stream);
+}
+
+void ExplorationHub::onClose(crow::websocket::connection& conn) {
+    std::shared_ptr<Stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = streams.find(&conn);
+        if (it == streams.end()) return;
+        stream = std::move(it->second);
+        streams.erase(it);
+    }
+    stop(*stream);
+}
+
+void ExplorationHub::stop(Stream& stream) {
+    {
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        stream.open = false;
+    }
+    stream.wake.notify_all();
+    if (stream.worker.joinable()) stream.worker.join();
+}
+
+void ExplorationHub::run(Stream& stream, const Snapshot& snapshot) const {
+    using Clock = std::chrono::steady_clock;
+    std::vector<uint32_t> settled, frontier;
+    Clock::time_point lastFlush = Clock::now() - options.slice;
+
+    // Send the current batch once the window has room and the slice is over.
+    // Without wait this only sends if that is already the case; returns false
+    // once the socket is gone.
+    auto flush = [&](bool wait) {
+        std::unique_lock<std::mutex> lock(stream.mutex);
+        while (stream.open) {
+            const bool windowOpen = stream.sent - stream.acked < options.window;
+            const Clock::time_point sliceEnd = lastFlush + options.slice;
+            if (windowOpen && Clock::now() >= sliceEnd) break;
+            if (!wait) return true;
+            if (windowOpen) stream.wake.wait_until(lock, sliceEnd);
+            else stream.wake.wait(lock);
+        }
+        if (!stream.open) return false;
+
+        std::string frame;
+        frame.reserve(13 + (settled.size() + frontier.size()) * 6);
+        frame.push_back(static_cast<char>(BATCH));
+        putU32(frame, stream.sent++);
+        putU32(frame, static_cast<uint32_t>(settled.size()));
+        putU32(frame, static_cast<uint32_t>(frontier.size()));
+        snapshot.putCoordinates(frame, settled);
+        snapshot.putCoordinates(frame, frontier);
+        stream.conn->send_binary(std::move(frame));
+        lastFlush = Clock::now();
+        settled.clear();
+        frontier.clear();
+        return true;
+    };
+
+    // A* as in Graph::findPath, with a closed set so every node is settled
+    // once; the shared library runs it and this visitor streams its progress
+    struct Progress : shortest_path::SearchVisitor {
+        std::vector<uint32_t>& settled;
+        std::vector<uint32_t>& frontier;
+        std::vector<uint32_t> parentEdge, parent;
+        const Snapshot& snapshot;
+        const Options& options;
+        decltype(flush)& flushBatch;
+        size_t settledCount = 0;
+        bool reachedEnd = false;
+        bool aborted = false;
+
+        Progress(std::vector<uint32_t>& settled, std::vector<uint32_t>& frontier, const Snapshot& snapshot,
+                 const Options& options, decltype(flush)& flushBatch)
+            : settled(settled), frontier(frontier), parentEdge(snapshot.lat.size(), NONE),
+              parent(snapshot.lat.size(), NONE), snapshot(snapshot), options(options), flushBatch(flushBatch) {}
+
+        bool settle(uint32_t u) {
+            settled.push_back(u);
+            if (u == snapshot.end) reachedEnd = true;
+            return true;
+        }
+        void improve(uint32_t u, uint32_t x, size_t e) {
+            parent[x] = u;
+            parentEdge[x] = static_cast<uint32_t>(e);
+            frontier.push_back(x);
+        }
+        bool scanned(uint32_t) {
+            if (settled.size() + frontier.size() >= options.maxBatch) {
+                aborted = !flushBatch(true);
+            } else if (++settledCount % CLOCK_CHECK_INTERVAL == 0) {
+                aborted = !flushBatch(false);
+            }
+            return !aborted;
+        }
+    } progress(settled, frontier, snapshot, options, flush);
+
+    const shortest_path::CsrLayout<float> layout(snapshot.offsets.data(), snapshot.targets.data(),
+                                                 snapshot.weights.data(), snapshot.lat.size());
+    const auto heuristic = shortest_path::makeHeuristic<double>([&snapshot](uint32_t node) {
+        return snapshot.heuristic(node);
+    });
+    std::vector<double> dist;
+    frontier.push_back(snapshot.start);
+    shortest_path::search<double, shortest_path::BinaryHeapQueue>(layout, snapshot.start, snapshot.end, dist,
+                                                                   heuristic, progress);
+    if (progress.aborted) return;
+    if ((!settled.empty() || !frontier.empty()) && !flush(true)) return;
+
+    // Final frame: the path found, then the server closes the socket
+    std::vector<uint32_t> path;
+    double length = 0.0;
+    if (progress.reachedEnd) {
+        for (uint32_t at = snapshot.end; at != NONE; at = progress.parent[at]) {
+            path.push_back(at);
+            if (progress.parentEdge[at] != NONE) length += snapshot.lengths[progress.parentEdge[at]];
+        }
+        std::reverse(path.begin(), path.end());
+    }
+    std::unique_lock<std::mutex> lock(stream.mutex);
+    stream.wake.wait(lock, [&] { return !stream.open || stream.sent - stream.acked < options.window; });
+    if (!stream.open) return;
+    std::string frame;
+    frame.push_back(static_cast<char>(PATH));
+    putU32(frame, stream.sent++);
+    putF64(frame, length);
+    putU32(frame, static_cast<uint32_t>(path.size()));
+    snapshot.putCoordinates(frame, path);
+    stream.conn->send_binary(std::move(frame));
+    stream.conn->close("Exploration finished");
+}
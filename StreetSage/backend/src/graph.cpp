@@ -4,6 +4,262 @@
 #include <stdexcept>
 #include <limits>
 #include <iostream>
+#include <array>
+#include <exception>
+#include <thread>
+#include <tuple>
+#include <async_log/log.hpp>
+
+namespace {
+
+// Weekday congestion curve: morning and evening peaks scaled by `peak`
+std::vector<std::pair<double, double>> congestionCurve(double peak) {
+    return {
+        {0.0, 1.0}, {6.0, 1.0}, {8.0, 1.0 + peak}, {10.0, 1.0 + 0.3 * peak},
+        {16.0, 1.0 + 0.3 * peak}, {17.5, 1.0 + peak}, {19.5, 1.0 + 0.2 * peak}, {22.0, 1.0}
+    };
+}
+
+struct BuiltinProfile {
+    const char* name;
+    double peak;
+};
+
+// The first entry becomes Graph::DEFAULT_PROFILE, used for untagged ways
+const std::vector<BuiltinProfile> BUILTIN_PROFILES = {
+    {"default", 0.5},
+    {"motorway", 0.8},
+    {"arterial", 0.9},
+    {"collector", 0.6},
+    {"local", 0.2},
+};
+
+// Default speeds per highway class; 0 closes the class to that vehicle
+struct HighwayClass {
+    const char* highway;
+    double carKmh;
+    double bikeKmh;
+    const char* profile;
+};
+
+const std::vector<HighwayClass> HIGHWAY_CLASSES = {
+    {"motorway", 100.0, 0.0, "motorway"},
+    {"motorway_link", 60.0, 0.0, "motorway"},
+    {"trunk", 80.0, 0.0, "motorway"},
+    {"trunk_link", 50.0, 0.0, "motorway"},
+    {"primary", 60.0, 18.0, "arterial"},
+    {"primary_link", 45.0, 18.0, "arterial"},
+    {"secondary", 50.0, 18.0, "arterial"},
+    {"secondary_link", 40.0, 18.0, "arterial"},
+    {"tertiary", 40.0, 18.0, "collector"},
+    {"tertiary_link", 35.0, 18.0, "collector"},
+    {"unclassified", 35.0, 16.0, "collector"},
+    {"residential", 30.0, 16.0, "local"},
+    {"living_street", 10.0, 12.0, "local"},
+    {"service", 20.0, 14.0, "local"},
+    {"road", 30.0, 15.0, "local"},
+    {"cycleway", 0.0, 20.0, "local"},
+};
+
+constexpr double DEFAULT_CAR_KMH = 35.0;
+constexpr double DEFAULT_BIKE_KMH = 16.0;
+
+const HighwayClass* findHighwayClass(const std::string& highway) {
+    for (const auto& highwayClass : HIGHWAY_CLASSES) {
+        if (highway == highwayClass.highway) return &highwayClass;
+    }
+    return nullptr;
+}
+
+// Parse an OSM maxspeed value ("50", "30 mph"); 0 if absent or symbolic
+double parseMaxspeed(const json& tags) {
+    auto it = tags.find("maxspeed");
+    if (it == tags.end() || !it->is_string()) return 0.0;
+    const std::string& value = it->get_ref<const std::string&>();
+    char* endPtr = nullptr;
+    double speed = std::strtod(value.c_str(), &endPtr);
+    if (endPtr == value.c_str() || !(speed > 0)) return 0.0;
+    if (value.find("mph") != std::string::npos) speed *= 1.609344;
+    return std::clamp(speed, 5.0, 150.0);
+}
+
+int parseOneway(const json& tags) {
+    auto it = tags.find("oneway");
+    if (it == tags.end() || !it->is_string()) return 0;
+    const std::string& value = it->get_ref<const std::string&>();
+    if (value == "yes" || value == "true" || value == "1") return 1;
+    if (value == "-1" || value == "reverse") return -1;
+    return 0;
+}
+
+double timeOfDay(double timestamp) {
+    double t = std::fmod(timestamp, 86400.0);
+    if (t < 0) t += 86400.0;
+    // A tiny negative remainder rounds up to a whole day
+    return t < 86400.0 ? t : 0.0;
+}
+
+// Min-heap whose storage comes from a search's memory resource
+template <typename T>
+using MinQueue = std::priority_queue<T, std::pmr::vector<T>, std::greater<T>>;
+
+// Below this many elements per thread a load runs on fewer threads
+constexpr size_t MIN_ELEMENTS_PER_THREAD = 20000;
+
+// Run body(begin, end, chunk) over [0, count) split into one contiguous chunk
+// per thread; the calling thread takes the last chunk. The first exception
+// thrown by any chunk is rethrown once all have finished.
+template <typename Body>
+void parallelChunks(size_t count, unsigned threads, Body body) {
+    const size_t chunks = std::max<size_t>(1, threads);
+    std::vector<std::exception_ptr> errors(chunks);
+    std::vector<std::thread> pool;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        auto run = [&, chunk]() {
+            try {
+                body(count * chunk / chunks, count * (chunk + 1) / chunks, chunk);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+        if (chunk + 1 == chunks) run();
+        else pool.emplace_back(run);
+    }
+    for (auto& thread : pool) thread.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+// Sort contiguous runs on separate threads, then merge neighbouring runs pairwise
+template <typename T, typename Less>
+void parallelSort(std::vector<T>& items, unsigned threads, Less less) {
+    const size_t runs = std::max<size_t>(1, std::min<size_t>(threads, items.size()));
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t run = 0; run <= runs; ++run) bounds[run] = items.size() * run / runs;
+
+    parallelChunks(runs, static_cast<unsigned>(runs), [&](size_t begin, size_t end, size_t) {
+        for (size_t run = begin; run < end; ++run) {
+            std::sort(items.begin() + bounds[run], items.begin() + bounds[run + 1], less);
+        }
+    });
+    for (size_t width = 1; width < runs; width *= 2) {
+        const size_t merges = (runs + 2 * width - 1) / (2 * width);
+        parallelChunks(merges, static_cast<unsigned>(merges), [&](size_t begin, size_t end, size_t) {
+            for (size_t merge = begin; merge < end; ++merge) {
+                const size_t low = merge * 2 * width;
+                const size_t mid = std::min(low + width, runs);
+                const size_t high = std::min(low + 2 * width, runs);
+                if (mid < high) {
+                    std::inplace_merge(items.begin() + bounds[low], items.begin() + bounds[mid],
+                                       items.begin() + bounds[high], less);
+                }
+            }
+        });
+    }
+}
+
+} // namespace
+
+TravelTimeProfile TravelTimeProfile::fromBreakpoints(const std::string& name,
+                                                     const std::vector<std::pair<double, double>>& breakpoints) {
+    if (breakpoints.empty()) {
+        throw std::invalid_argument("Profile " + name + " needs at least one breakpoint");
+    }
+
+    auto points = breakpoints;
+    std::sort(points.begin(), points.end());
+    for (const auto& [hour, multiplier] : points) {
+        if (hour < 0 || hour >= 24 || !(multiplier > 0)) {
+            throw std::invalid_argument("Invalid breakpoint in profile " + name);
+        }
+    }
+
+    TravelTimeProfile profile;
+    profile.name = name;
+
+    // Resample the periodic piecewise-linear curve onto the fixed knots
+    for (int i = 0; i < SLOTS; ++i) {
+        const double hour = i * SLOT_SECONDS / 3600.0;
+        auto next = std::upper_bound(points.begin(), points.end(), std::make_pair(hour, std::numeric_limits<double>::infinity()));
+        auto [h1, m1] = next == points.begin() ? points.back() : *std::prev(next);
+        auto [h2, m2] = next == points.end() ? points.front() : *next;
+        if (h1 > hour) h1 -= 24.0;
+        if (h2 <= hour) h2 += 24.0;
+        const double multiplier = h2 > h1 ? m1 + (m2 - m1) * (hour - h1) / (h2 - h1) : m1;
+        profile.multiplierKnots[i] = static_cast<float>(multiplier);
+    }
+    profile.multiplierKnots[SLOTS] = profile.multiplierKnots[0];
+
+    // FIFO: leaving later must never mean arriving earlier on any edge we route over
+    profile.minMultiplier = profile.multiplierKnots[0];
+    for (int i = 0; i < SLOTS; ++i) {
+        const double slope = (profile.multiplierKnots[i + 1] - profile.multiplierKnots[i]) / SLOT_SECONDS;
+        if (slope * MAX_FIFO_EDGE_SECONDS < -1.0) {
+            throw std::invalid_argument("Profile " + name + " violates FIFO: congestion drops too steeply");
+        }
+        profile.minMultiplier = std::min<double>(profile.minMultiplier, profile.multiplierKnots[i]);
+    }
+
+    return profile;
+}
+
+Weighting parseWeighting(const std::string& name) {
+    if (name == "distance") return Weighting::Distance;
+    if (name == "car") return Weighting::CarTime;
+    if (name == "bike") return Weighting::BikeTime;
+    throw std::invalid_argument("Unknown routing profile: " + name);
+}
+
+Graph::Graph() {
+    std::unordered_map<std::string, uint16_t> builtinIds;
+    for (const auto& builtin : BUILTIN_PROFILES) {
+        builtinIds[builtin.name] = addProfile(TravelTimeProfile::fromBreakpoints(
+            builtin.name, congestionCurve(builtin.peak)));
+    }
+    for (const auto& highwayClass : HIGHWAY_CLASSES) {
+        assignHighwayProfile(highwayClass.highway, builtinIds.at(highwayClass.profile));
+    }
+}
+
+uint16_t Graph::addProfile(TravelTimeProfile profile) {
+    if (profiles.size() >= std::numeric_limits<uint16_t>::max()) {
+        throw std::length_error("Too many travel-time profiles");
+    }
+    minMultiplier = profiles.empty() ? profile.minMultiplier
+                                     : std::min(minMultiplier, profile.minMultiplier);
+    profiles.push_back(std::move(profile));
+    return static_cast<uint16_t>(profiles.size() - 1);
+}
+
+void Graph::assignHighwayProfile(const std::string& highway, uint16_t profileId) {
+    if (profileId >= profiles.size()) {
+        throw std::out_of_range("Profile ID not found");
+    }
+    profileByHighway[highway] = profileId;
+}
+
+Graph::WayAttributes Graph::parseWay(const json& way) const {
+    WayAttributes attributes{DEFAULT_PROFILE, DEFAULT_CAR_KMH, DEFAULT_BIKE_KMH, 0};
+    auto tags = way.find("tags");
+    if (tags == way.end() || !tags->is_object()) return attributes;
+
+    auto highway = tags->find("highway");
+    if (highway != tags->end() && highway->is_string()) {
+        const std::string& name = highway->get_ref<const std::string&>();
+        if (const HighwayClass* highwayClass = findHighwayClass(name)) {
+            attributes.carKmh = highwayClass->carKmh;
+            attributes.bikeKmh = highwayClass->bikeKmh;
+        }
+        auto it = profileByHighway.find(name);
+        if (it != profileByHighway.end()) attributes.profile = it->second;
+    }
+
+    const double maxspeed = parseMaxspeed(*tags);
+    if (maxspeed > 0 && attributes.carKmh > 0) attributes.carKmh = maxspeed;
+    attributes.oneway = parseOneway(*tags);
+    return attributes;
+}
 
 // Haversine distance calculation
 double Graph::haversineDistance(double lat1, double lon1, double lat2, double lon2) const {
@@ -21,19 +277,24 @@ double Graph::haversineDistance(double lat1, double lon1, double lat2, double lo
     return R * c;
 }
 
-double Graph::calculateAngle(const std::pair<double, double>& prev, const std::pair<double, double>& curr, const std::pair<double, double>& next,double prevAngle) const {
-
-    double lat2 = curr.first * M_PI / 180;
-    double lon2 = curr.second * M_PI / 180;
-    double lat3 = next.first * M_PI / 180;
-    double lon3 = next.second * M_PI / 180;
+// Initial bearing from one coordinate to another, in degrees [0, 360)
+double Graph::bearing(const std::pair<double, double>& from, const std::pair<double, double>& to) {
+    double lat2 = from.first * M_PI / 180;
+    double lon2 = from.second * M_PI / 180;
+    double lat3 = to.first * M_PI / 180;
+    double lon3 = to.second * M_PI / 180;
 
     double angle = std::atan2(
         std::sin(lon3 - lon2) * std::cos(lat3),
         std::cos(lat2) * std::sin(lat3) - std::sin(lat2) * std::cos(lat3) * std::cos(lon3 - lon2)
     );
 
-    double bearing = std::fmod((angle * 180 / M_PI + 360), 360);
+    return std::fmod((angle * 180 / M_PI + 360), 360);
+}
+
+double Graph::calculateAngle(const std::pair<double, double>& prev, const std::pair<double, double>& curr, const std::pair<double, double>& next,double prevAngle) const {
+
+    double bearing = Graph::bearing(curr, next);
 
     // Adjust the angle to be smooth with the previous angle
     double angleDiff = bearing - prevAngle;
@@ -60,18 +321,28 @@ double Graph::heuristic(int64_t node, int64_t goal) const {
     }
 }
 
-void Graph::loadFromJSON(const json& data) {
+void Graph::loadFromJSON(const json& data, unsigned threads) {
     try {
         // Clear existing data
         clear();
 
-        // Pre-allocate space
-        auto& elements = data["elements"];
-        nodes.reserve(elements.size());
-        
-        // First pass: Load all nodes
-        for (auto& element : elements) {
-            if (element["type"] == "node") {
+        const auto& elements = data.at("elements");
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        // Small extracts are not worth starting threads for
+        threads = static_cast<unsigned>(std::clamp<size_t>(elements.size() / MIN_ELEMENTS_PER_THREAD, 1, threads));
+
+        // First pass: nodes, parsed into per-thread buffers
+        struct NodeRecord {
+            int64_t id;
+            double lat;
+            double lon;
+        };
+        std::vector<std::vector<NodeRecord>> nodeBuffers(threads);
+        parallelChunks(elements.size(), threads, [&](size_t begin, size_t end, size_t chunk) {
+            auto& buffer = nodeBuffers[chunk];
+            for (size_t i = begin; i < end; ++i) {
+                const json& element = elements[i];
+                if (element["type"] != "node") continue;
                 int64_t id = element["id"];
                 double lat = element["lat"];
                 double lon = element["lon"];
@@ -79,60 +350,166 @@ void Graph::loadFromJSON(const json& data) {
                 if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
                     throw std::invalid_argument("Invalid coordinates in node " + std::to_string(id));
                 }
-                
-                nodes[id] = {lat, lon};
+                buffer.push_back({id, lat, lon});
             }
+        });
+        size_t nodeCount = 0;
+        for (const auto& buffer : nodeBuffers) nodeCount += buffer.size();
+        nodes.reserve(nodeCount);
+        for (const auto& buffer : nodeBuffers) {
+            for (const auto& node : buffer) nodes[node.id] = {node.lat, node.lon};
         }
-
-        // Second pass: Create edges
-        size_t edge_count = 0;
-        for (const auto& element : elements) {
-            if (element["type"] == "way") {
+        nodeBuffers.clear();
+
+        // Second pass: way segments into per-thread buffers. A segment is stored
+        // once, oriented from the lower to the higher node id, with the weights
+        // of both directions: weight[2w] low -> high, weight[2w + 1] high -> low.
+        struct Segment {
+            int64_t low;
+            int64_t high;
+            double distance;
+            uint16_t profile;
+            std::array<float, 2 * WEIGHTING_COUNT> weight;
+        };
+        std::vector<std::vector<Segment>> segmentBuffers(threads);
+        parallelChunks(elements.size(), threads, [&](size_t begin, size_t end, size_t chunk) {
+            auto& buffer = segmentBuffers[chunk];
+            const float inf = std::numeric_limits<float>::infinity();
+            for (size_t i = begin; i < end; ++i) {
+                const json& element = elements[i];
+                if (element["type"] != "way") continue;
                 const auto& nodeRefs = element["nodes"];
-                const size_t size = nodeRefs.size();
-                
+
                 // Skip ways with less than 2 nodes
-                if (size < 2) continue;
-                
-                // Pre-count edges for this way
-                edge_count += size - 1;
-                
-                // Create edges between consecutive nodes
-                for (size_t i = 0; i < size - 1; ++i) {
-                    int64_t src = nodeRefs[i];
-                    int64_t dst = nodeRefs[i + 1];
-                    
-                    // Validate node existence
-                    if (!nodes.count(src) || !nodes.count(dst)) {
-                        continue; // Skip invalid node references
-                    }
-                    
-                    const auto& src_coords = nodes[src];
-                    const auto& dst_coords = nodes[dst];
-                    
-                    // Calculate and cache distance
-                    auto distance = haversineDistance(
-                        src_coords.first, src_coords.second,
-                        dst_coords.first, dst_coords.second
+                if (nodeRefs.size() < 2) continue;
+                const WayAttributes way = parseWay(element);
+
+                for (size_t j = 0; j + 1 < nodeRefs.size(); ++j) {
+                    const int64_t src = nodeRefs[j];
+                    const int64_t dst = nodeRefs[j + 1];
+
+                    // Skip invalid node references and degenerate segments
+                    auto srcNode = nodes.find(src);
+                    auto dstNode = nodes.find(dst);
+                    if (srcNode == nodes.end() || dstNode == nodes.end() || src == dst) continue;
+
+                    const double distance = haversineDistance(
+                        srcNode->second.first, srcNode->second.second,
+                        dstNode->second.first, dstNode->second.second
                     );
-                    
-                    // Create bidirectional edges
-                    edges[src].push_back({dst, distance});
-                    edges[dst].push_back({src, distance});
-                    
-                    // Cache distances for both directions
-                    distanceCache[{src, dst}] = distance;
-                    distanceCache[{dst, src}] = distance;
+
+                    // Per-weighting costs, infinite where the direction or vehicle is not allowed
+                    const float carTime = way.carKmh > 0 ? static_cast<float>(distance * 3.6 / way.carKmh) : inf;
+                    const float bikeTime = way.bikeKmh > 0 ? static_cast<float>(distance * 3.6 / way.bikeKmh) : inf;
+                    const std::array<float, WEIGHTING_COUNT> forward = {
+                        static_cast<float>(distance), way.oneway >= 0 ? carTime : inf, way.oneway >= 0 ? bikeTime : inf
+                    };
+                    const std::array<float, WEIGHTING_COUNT> backward = {
+                        static_cast<float>(distance), way.oneway <= 0 ? carTime : inf, way.oneway <= 0 ? bikeTime : inf
+                    };
+
+                    Segment segment{std::min(src, dst), std::max(src, dst), distance, way.profile, {}};
+                    const size_t flipped = src > dst ? 1 : 0;
+                    for (size_t w = 0; w < WEIGHTING_COUNT; ++w) {
+                        segment.weight[2 * w + flipped] = forward[w];
+                        segment.weight[2 * w + 1 - flipped] = backward[w];
+                    }
+                    buffer.push_back(segment);
                 }
             }
+        });
+
+        std::vector<Segment> segments;
+        size_t segmentCount = 0;
+        for (const auto& buffer : segmentBuffers) segmentCount += buffer.size();
+        segments.reserve(segmentCount);
+        for (auto& buffer : segmentBuffers) {
+            segments.insert(segments.end(), buffer.begin(), buffer.end());
+            std::vector<Segment>().swap(buffer);
         }
 
-        // Reserve space for edge vectors based on average connectivity
-        if (!nodes.empty()) {
-            size_t avg_edges_per_node = (edge_count * 2) / nodes.size();
-            for (auto& [_, edge_vec] : edges) {
-                edge_vec.reserve(avg_edges_per_node);
+        // Merge parallel edges (ways sharing a segment, overlapping extracts):
+        // each direction keeps its cheapest weight, and the profile follows
+        // the faster car direction so the result does not depend on sort order
+        parallelSort(segments, threads, [](const Segment& a, const Segment& b) {
+            return std::tie(a.low, a.high) < std::tie(b.low, b.high);
+        });
+        constexpr size_t CAR = static_cast<size_t>(Weighting::CarTime);
+        auto carKey = [](const Segment& segment) {
+            return std::make_pair(std::min(segment.weight[2 * CAR], segment.weight[2 * CAR + 1]), segment.profile);
+        };
+        size_t unique = 0;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            Segment& last = segments[unique > 0 ? unique - 1 : 0];
+            if (unique > 0 && last.low == segments[i].low && last.high == segments[i].high) {
+                if (carKey(segments[i]) < carKey(last)) last.profile = segments[i].profile;
+                for (size_t k = 0; k < last.weight.size(); ++k) {
+                    last.weight[k] = std::min(last.weight[k], segments[i].weight[k]);
+                }
+                continue;
             }
+            segments[unique++] = segments[i];
+        }
+        segments.resize(unique);
+
+        // Directed edges: segment k becomes ids 2k (low -> high) and 2k + 1 (high -> low)
+        struct DirectedEdge {
+            int64_t from;
+            Edge edge;
+        };
+        std::vector<DirectedEdge> directed(2 * unique);
+        for (auto& array : weights) array.resize(2 * unique);
+        parallelChunks(unique, threads, [&](size_t begin, size_t end, size_t) {
+            for (size_t k = begin; k < end; ++k) {
+                const Segment& segment = segments[k];
+                const auto& lowCoords = nodes.at(segment.low);
+                const auto& highCoords = nodes.at(segment.high);
+
+                // Bearings at both ends; arriving heading is the reverse of the departing one
+                const float forward = static_cast<float>(bearing(lowCoords, highCoords));
+                const float backward = static_cast<float>(bearing(highCoords, lowCoords));
+                const float forwardIn = std::fmod(backward + 180.0f, 360.0f);
+                const float backwardIn = std::fmod(forward + 180.0f, 360.0f);
+
+                const uint32_t forwardId = static_cast<uint32_t>(2 * k);
+                directed[2 * k] = {segment.low, {segment.high, segment.distance, forwardId, segment.profile, forward, forwardIn}};
+                directed[2 * k + 1] = {segment.high, {segment.low, segment.distance, forwardId + 1, segment.profile, backward, backwardIn}};
+                for (size_t w = 0; w < WEIGHTING_COUNT; ++w) {
+                    weights[w][2 * k] = segment.weight[2 * w];
+                    weights[w][2 * k + 1] = segment.weight[2 * w + 1];
+                }
+            }
+        });
+
+        // Group by source (CSR order). Only creating the map entries is serial;
+        // the exactly sized edge vectors are filled on the worker threads.
+        parallelSort(directed, threads, [](const DirectedEdge& a, const DirectedEdge& b) {
+            return std::tie(a.from, a.edge.id) < std::tie(b.from, b.edge.id);
+        });
+        std::vector<size_t> starts;
+        for (size_t i = 0; i < directed.size(); ++i) {
+            if (i == 0 || directed[i].from != directed[i - 1].from) starts.push_back(i);
+        }
+        std::vector<std::vector<Edge>*> lists(starts.size());
+        edges.reserve(starts.size());
+        for (size_t s = 0; s < starts.size(); ++s) lists[s] = &edges[directed[starts[s]].from];
+        starts.push_back(directed.size());
+        parallelChunks(lists.size(), threads, [&](size_t begin, size_t end, size_t) {
+            for (size_t s = begin; s < end; ++s) {
+                lists[s]->reserve(starts[s + 1] - starts[s]);
+                for (size_t k = starts[s]; k < starts[s + 1]; ++k) lists[s]->push_back(directed[k].edge);
+            }
+        });
+
+        // Fastest rate of each weighting, so haversine * rate never overestimates
+        for (size_t w = 0; w < WEIGHTING_COUNT; ++w) {
+            double best = std::numeric_limits<double>::infinity();
+            for (const auto& segment : segments) {
+                if (segment.distance > 0) {
+                    best = std::min(best, std::min(segment.weight[2 * w], segment.weight[2 * w + 1]) / segment.distance);
+                }
+            }
+            minWeightPerMeter[w] = std::isfinite(best) ? best : 0.0;
         }
 
     } catch (const json::exception& e) {
@@ -142,11 +519,14 @@ void Graph::loadFromJSON(const json& data) {
     }
 }
 
-std::vector<json> Graph::findPath(const json& start, const json& end) {
+std::vector<json> Graph::findPath(const json& start, const json& end, Weighting weighting,
+                                  std::pmr::memory_resource* memory) {
     // Validate input nodes
     if (!nodes.count(start["id"]) || !nodes.count(end["id"])) {
         return {};
     }
+    const int64_t startId = start["id"];
+    const int64_t endId = end["id"];
 
     // Custom comparator for the priority queue
     struct CompareNode {
@@ -156,24 +536,27 @@ std::vector<json> Graph::findPath(const json& start, const json& end) {
         }
     };
 
-    // Initialize data structures
-    std::unordered_map<int64_t, double> gScore;
-    std::unordered_map<int64_t, int64_t> prev;
+    // Search state lives in the caller's memory resource; nodes the search
+    // never reaches have no entry and count as infinitely far
+    std::pmr::unordered_map<int64_t, double> gScore(memory);
+    std::pmr::unordered_map<int64_t, int64_t> prev(memory);
     std::priority_queue<
         std::pair<double, int64_t>,
-        std::vector<std::pair<double, int64_t>>,
+        std::pmr::vector<std::pair<double, int64_t>>,
         CompareNode
-    > pq;
+    > pq{CompareNode(), std::pmr::vector<std::pair<double, int64_t>>(memory)};
+    auto scoreOf = [&gScore](int64_t node) {
+        auto it = gScore.find(node);
+        return it == gScore.end() ? std::numeric_limits<double>::infinity() : it->second;
+    };
 
-    // Initialize scores
-    gScore.reserve(nodes.size());
-    for (const auto& node : nodes) {
-        gScore[node.first] = std::numeric_limits<double>::infinity();
-    }
-    gScore[start["id"]] = 0;
+    gScore[startId] = 0;
+
+    const auto& weight = weights[static_cast<size_t>(weighting)];
+    const double rate = minWeightPerMeter[static_cast<size_t>(weighting)];
 
     // Initialize priority queue with start node
-    pq.push({heuristic(start["id"], end["id"]), start["id"]});
+    pq.push({heuristic(startId, endId) * rate, startId});
 
     // A* algorithm
     
@@ -182,61 +565,252 @@ std::vector<json> Graph::findPath(const json& start, const json& end) {
         pq.pop();
 
         // Found the destination
-        if (current == end["id"]) break;
+        if (current == endId) break;
 
         // Look at all neighbors
         auto it = edges.find(current);
         if (it == edges.end()) continue;
 
-        for (const auto& [next, weight] : it->second) {
-            double newScore = gScore[current] + weight;
+        const double currentScore = gScore.at(current);
+        for (const auto& edge : it->second) {
+            double newScore = currentScore + weight[edge.id];
             
-            if (newScore < gScore[next]) {
-                prev[next] = current;
-                gScore[next] = newScore;
-                double priority = newScore + heuristic(next, end["id"]);
-                pq.push({priority, next});
+            if (newScore < scoreOf(edge.to)) {
+                prev[edge.to] = current;
+                gScore[edge.to] = newScore;
+                double priority = newScore + heuristic(edge.to, endId) * rate;
+                pq.push({priority, edge.to});
             }
         }
     }
 
     // Check if path exists
-    if (gScore[end["id"]] == std::numeric_limits<double>::infinity()) {
+    if (scoreOf(endId) == std::numeric_limits<double>::infinity()) {
+        return {};
+    }
+
+    return reconstructPath(startId, endId, prev);
+}
+
+std::vector<json> Graph::findPath(const json& start, const json& end, double departureTime, int utcOffset,
+                                  std::pmr::memory_resource* memory) {
+    // Validate input nodes
+    if (!nodes.count(start["id"]) || !nodes.count(end["id"])) {
+        return {};
+    }
+    const int64_t startId = start["id"];
+    const int64_t endId = end["id"];
+
+    // Queue entries remember the arrival time they were pushed with so that
+    // stale entries can be skipped without a closed set
+    struct QueueEntry {
+        double priority;
+        double arrival;
+        int64_t node;
+        bool operator>(const QueueEntry& other) const { return priority > other.priority; }
+    };
+
+    std::pmr::unordered_map<int64_t, double> arrival(memory);
+    std::pmr::unordered_map<int64_t, int64_t> prev(memory);
+    MinQueue<QueueEntry> pq{std::greater<QueueEntry>(), std::pmr::vector<QueueEntry>(memory)};
+
+    const auto& carTimes = weights[static_cast<size_t>(Weighting::CarTime)];
+    const double rate = minWeightPerMeter[static_cast<size_t>(Weighting::CarTime)] * minMultiplier;
+
+    arrival[startId] = departureTime;
+    pq.push({departureTime + heuristic(startId, endId) * rate, departureTime, startId});
+
+    // Time-dependent A*: with FIFO profiles, waiting never helps, so the
+    // earliest arrival at a node is all we need to expand it
+    while (!pq.empty()) {
+        const QueueEntry top = pq.top();
+        pq.pop();
+
+        if (top.node == endId) break;
+        if (top.arrival > arrival[top.node]) continue;
+
+        auto it = edges.find(top.node);
+        if (it == edges.end()) continue;
+
+        const double secondOfDay = timeOfDay(top.arrival + utcOffset);
+        for (const auto& edge : it->second) {
+            const float freeFlow = carTimes[edge.id];
+            if (std::isinf(freeFlow)) continue;
+            const double t = top.arrival + freeFlow * profiles[edge.profile].multiplier(secondOfDay);
+            auto [slot, inserted] = arrival.try_emplace(edge.to, t);
+            if (inserted || t < slot->second) {
+                slot->second = t;
+                prev[edge.to] = top.node;
+                pq.push({t + heuristic(edge.to, endId) * rate, t, edge.to});
+            }
+        }
+    }
+
+    if (!arrival.count(endId)) {
         return {};
     }
 
-    // Reconstruct path
+    return reconstructPath(startId, endId, prev, &arrival);
+}
+
+std::vector<json> Graph::findPath(const json& start, const json& end, const TurnCosts& turnCosts,
+                                  Weighting weighting, std::pmr::memory_resource* memory) {
+    // Validate input nodes
+    if (!nodes.count(start["id"]) || !nodes.count(end["id"])) {
+        return {};
+    }
+    const int64_t startId = start["id"];
+    const int64_t endId = end["id"];
+    if (startId == endId) {
+        return buildPath({startId});
+    }
+
+    // Search states are directed edges (tail node, index into edges[tail]);
+    // their successors come straight from the node adjacency, so the line
+    // graph is never materialised and memory stays proportional to what
+    // the search touches
+    using EdgeRef = std::pair<int64_t, uint32_t>;
+    struct QueueEntry {
+        double priority;
+        double cost;
+        EdgeRef ref;
+        const Edge* edge;
+        bool operator>(const QueueEntry& other) const { return priority > other.priority; }
+    };
+
+    std::pmr::unordered_map<EdgeRef, double, PairHash> cost(memory);
+    std::pmr::unordered_map<EdgeRef, EdgeRef, PairHash> prev(memory);
+    MinQueue<QueueEntry> pq{std::greater<QueueEntry>(), std::pmr::vector<QueueEntry>(memory)};
+
+    const auto& weight = weights[static_cast<size_t>(weighting)];
+    const double rate = minWeightPerMeter[static_cast<size_t>(weighting)];
+    // Penalties are metres; express them in the weighting's units at its fastest rate
+    TurnCosts scaled = turnCosts;
+    scaled.turnPenalty *= rate;
+    scaled.uTurnPenalty *= rate;
+
+    auto startIt = edges.find(startId);
+    if (startIt == edges.end()) return {};
+    for (uint32_t i = 0; i < startIt->second.size(); ++i) {
+        const Edge& edge = startIt->second[i];
+        const double edgeCost = weight[edge.id];
+        if (std::isinf(edgeCost)) continue;
+        EdgeRef ref{startId, i};
+        auto [slot, inserted] = cost.try_emplace(ref, edgeCost);
+        if (inserted || edgeCost < slot->second) {
+            slot->second = edgeCost;
+            pq.push({edgeCost + heuristic(edge.to, endId) * rate, edgeCost, ref, &edge});
+        }
+    }
+
+    bool found = false;
+    EdgeRef last{};
+    while (!pq.empty()) {
+        const QueueEntry top = pq.top();
+        pq.pop();
+
+        if (top.cost > cost[top.ref]) continue;
+        if (top.edge->to == endId) {
+            found = true;
+            last = top.ref;
+            break;
+        }
+
+        auto it = edges.find(top.edge->to);
+        if (it == edges.end()) continue;
+
+        const auto& outgoing = it->second;
+        for (uint32_t i = 0; i < outgoing.size(); ++i) {
+            const Edge& next = outgoing[i];
+            if (std::isinf(weight[next.id])) continue;
+            const bool uTurn = next.to == top.ref.first;
+            const double newCost = top.cost + weight[next.id] +
+                                   scaled.penalty(top.edge->bearingIn, next.bearingOut, uTurn);
+            EdgeRef ref{top.edge->to, i};
+            auto [slot, inserted] = cost.try_emplace(ref, newCost);
+            if (inserted || newCost < slot->second) {
+                slot->second = newCost;
+                prev[ref] = top.ref;
+                pq.push({newCost + heuristic(next.to, endId) * rate, newCost, ref, &next});
+            }
+        }
+    }
+
+    if (!found) {
+        return {};
+    }
+
+    // Unwind the edge chain into the node sequence it traverses
+    std::vector<int64_t> sequence = {endId};
+    for (EdgeRef ref = last; ; ) {
+        sequence.push_back(ref.first);
+        auto it = prev.find(ref);
+        if (it == prev.end()) break;
+        ref = it->second;
+    }
+    std::reverse(sequence.begin(), sequence.end());
+    return buildPath(sequence);
+}
+
+std::vector<json> Graph::reconstructPath(int64_t startId, int64_t endId,
+                                         const std::pmr::unordered_map<int64_t, int64_t>& prev,
+                                         const std::pmr::unordered_map<int64_t, double>* arrival) const {
+    std::vector<int64_t> sequence = {endId};
+    for (int64_t at = endId; at != startId; ) {
+        auto it = prev.find(at);
+        if (it == prev.end()) return {};
+        at = it->second;
+        sequence.push_back(at);
+    }
+    std::reverse(sequence.begin(), sequence.end());
+    return buildPath(sequence, arrival);
+}
+
+std::vector<json> Graph::buildPath(const std::vector<int64_t>& sequence,
+                                   const std::pmr::unordered_map<int64_t, double>* arrival) const {
     std::vector<json> path;
-    path.reserve(nodes.size() / 4);  // Reasonable initial capacity
+    if (sequence.empty()) return path;
+    path.reserve(sequence.size());
     
+    // Duplicate segments are merged on load, so at most one edge joins two nodes
+    auto distanceBetween = [this](int64_t from, int64_t to) {
+        for (const Edge& edge : edges.at(from)) {
+            if (edge.to == to) return edge.distance;
+        }
+        throw std::out_of_range("No edge between consecutive path nodes");
+    };
+
+    // Walk backwards from the destination so angles are smoothed the same way as before
     double prevAngle = 0.0;
-    for (int64_t at = end["id"]; at != start["id"]; ) {
-        auto it = prev.find(at);
-        if (it == prev.end()) return {}; 
-        
-        int64_t prevNode = it->second;
-        double distance = distanceCache[{prevNode, at}];
-        double angle = calculateAngle(nodes[prevNode], nodes[at], nodes[it->second], prevAngle);
+    for (size_t i = sequence.size() - 1; i > 0; --i) {
+        const int64_t at = sequence[i];
+        const int64_t prevNode = sequence[i - 1];
+        double distance = distanceBetween(prevNode, at);
+        double angle = calculateAngle(nodes.at(prevNode), nodes.at(at), nodes.at(prevNode), prevAngle);
         
-        path.push_back(json{
+        json step = {
             {"id", at},
             {"lat", nodes.at(at).first},
             {"lon", nodes.at(at).second},
             {"type", "node"},
             {"distance", distance},
             {"angle", angle}
-        });
+        };
+        if (arrival) step["time"] = arrival->at(at);
+        path.push_back(std::move(step));
         prevAngle = angle;
-        at = it->second;
     }
-    path.push_back(json{
-        {"id", start["id"]},
-        {"lat", nodes.at(start["id"]).first},
-        {"lon", nodes.at(start["id"]).second},
+    const int64_t startId = sequence.front();
+    json first = {
+        {"id", startId},
+        {"lat", nodes.at(startId).first},
+        {"lon", nodes.at(startId).second},
         {"type", "node"},
         {"distance", 0.0},
         {"angle", 0.0}
-    });
+    };
+    if (arrival) first["time"] = arrival->at(startId);
+    path.push_back(std::move(first));
     
     std::reverse(path.begin(), path.end());
     return path;
@@ -245,8 +819,7 @@ std::vector<json> Graph::findPath(const json& start, const json& end) {
 json Graph::getPathState() const {
     json state = {
         {"node_count", nodes.size()},
-        {"edge_count", edges.size()},
-        {"cache_size", distanceCache.size()}
+        {"edge_count", edges.size()}
     };
 
     // Add some basic statistics
@@ -285,10 +858,10 @@ std::string Graph::printGraph() const {
     ss << "-----------------\n";
     for (const auto& [src, destinations] : edges) {
         ss << "From Node " << src << ":\n";
-        for (const auto& [dst, distance] : destinations) {
-            ss << "  → Node " << dst 
+        for (const auto& edge : destinations) {
+            ss << "  → Node " << edge.to 
                << " (distance: " << std::fixed << std::setprecision(2) 
-               << distance << "m)\n";
+               << edge.distance << "m, profile: " << profiles[edge.profile].name << ")\n";
         }
     }
     
@@ -297,7 +870,6 @@ std::string Graph::printGraph() const {
     ss << "-----------------\n";
     ss << "Total Nodes: " << nodes.size() << "\n";
     ss << "Total Edges: " << edges.size() << "\n";
-    ss << "Cached Distances: " << distanceCache.size() << "\n";
     
     // Calculate average connectivity
     if (!nodes.empty()) {
@@ -321,7 +893,7 @@ bool Graph::verifyGraph() const {
     for (const auto& [id, coords] : nodes) {
         if (coords.first < -90 || coords.first > 90 ||
             coords.second < -180 || coords.second > 180) {
-            std::cout << "Invalid coordinates for node " << id << std::endl;
+            async_log::warn("Invalid coordinates for node", {{"node", id}});
             return false;
         }
     }
@@ -330,35 +902,37 @@ bool Graph::verifyGraph() const {
     for (const auto& [src, destinations] : edges) {
         // Check if source node exists
         if (!nodes.count(src)) {
-            std::cout << "Edge references non-existent source node " << src << std::endl;
+            async_log::warn("Edge references non-existent source node", {{"node", src}});
             return false;
         }
         
         // Check each destination
-        for (const auto& [dst, distance] : destinations) {
-            if (!nodes.count(dst)) {
-                std::cout << "Edge references non-existent destination node " << dst << std::endl;
+        for (const auto& edge : destinations) {
+            if (edge.profile >= profiles.size()) {
+                async_log::warn("Edge references unknown profile", {{"from", src}, {"to", edge.to}, {"profile", edge.profile}});
+                return false;
+            }
+            if (!nodes.count(edge.to)) {
+                async_log::warn("Edge references non-existent destination node", {{"node", edge.to}});
                 return false;
             }
             
             // Verify distance is positive and reasonable
-            if (distance <= 0 || distance > 1000000) { // 1000km seems reasonable max
-                std::cout << "Suspicious distance " << distance 
-                         << "m between nodes " << src << " and " << dst << std::endl;
+            if (edge.distance <= 0 || edge.distance > 1000000) { // 1000km seems reasonable max
+                async_log::warn("Suspicious edge distance", {{"from", src}, {"to", edge.to}, {"metres", edge.distance}});
                 return false;
             }
             
             // Verify bidirectional edge exists
             bool found_reverse = false;
-            auto it = edges.find(dst);
+            auto it = edges.find(edge.to);
             if (it != edges.end()) {
-                for (const auto& [rev_dst, rev_dist] : it->second) {
-                    if (rev_dst == src) {
+                for (const auto& reverse : it->second) {
+                    if (reverse.to == src) {
                         found_reverse = true;
                         // Check if distances match
-                        if (std::abs(rev_dist - distance) > 0.01) {
-                            std::cout << "Inconsistent distances for bidirectional edge "
-                                     << src << " <-> " << dst << std::endl;
+                        if (std::abs(reverse.distance - edge.distance) > 0.01) {
+                            async_log::warn("Inconsistent distances for bidirectional edge", {{"from", src}, {"to", edge.to}});
                             return false;
                         }
                         break;
@@ -366,7 +940,7 @@ bool Graph::verifyGraph() const {
                 }
             }
             if (!found_reverse) {
-                std::cout << "Missing reverse edge for " << src << " -> " << dst << std::endl;
+                async_log::warn("Missing reverse edge", {{"from", src}, {"to", edge.to}});
                 return false;
             }
         }
@@ -0,0 +1,251 @@
+#include "graph.hpp"
+#include <queue>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <map>
+
+namespace {
+
+// Grid-raster outline of the reached area. Points are projected to a local
+// metric plane around the origin, dilated by one cell, holes are filled and
+// the outer boundary of the cell set is traced into a single ring.
+class RasterOutline {
+public:
+    RasterOutline(double originLat, double originLon, double cellSizeMeters)
+        : originLat(originLat), originLon(originLon), cellSize(cellSizeMeters),
+          metersPerDegLat(110540.0), metersPerDegLon(111320.0 * std::cos(originLat * M_PI / 180)) {}
+
+    void add(double lat, double lon) {
+        const long x = static_cast<long>(std::floor((lon - originLon) * metersPerDegLon / cellSize));
+        const long y = static_cast<long>(std::floor((lat - originLat) * metersPerDegLat / cellSize));
+        cells.emplace_back(x, y);
+    }
+
+    // Add points along a segment at most one cell apart
+    void addSegment(double lat1, double lon1, double lat2, double lon2, double lengthMeters) {
+        const long steps = std::max(1L, static_cast<long>(std::ceil(lengthMeters / cellSize)));
+        for (long i = 0; i <= steps; ++i) {
+            const double f = static_cast<double>(i) / steps;
+            add(lat1 + (lat2 - lat1) * f, lon1 + (lon2 - lon1) * f);
+        }
+    }
+
+    json polygon() const {
+        if (cells.empty()) return nullptr;
+
+        // Dense grid over the reached extent plus dilation and a one cell empty border
+        long minX = cells[0].first, maxX = minX, minY = cells[0].second, maxY = minY;
+        for (const auto& [x, y] : cells) {
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+        }
+        minX -= 2; minY -= 2; maxX += 2; maxY += 2;
+        const long width = maxX - minX + 1;
+        const long height = maxY - minY + 1;
+        if (width > Graph::MAX_ISOCHRONE_CELLS / height) {
+            throw std::invalid_argument("Isochrone area too large for this cell-size; use a larger cell-size");
+        }
+        enum : uint8_t { EMPTY, FILLED, OUTSIDE };
+        std::vector<uint8_t> grid(width * height, EMPTY);
+        auto at = [&](long x, long y) -> uint8_t& { return grid[(y - minY) * width + (x - minX)]; };
+
+        for (const auto& [x, y] : cells) {
+            for (long dy = -1; dy <= 1; ++dy) {
+                for (long dx = -1; dx <= 1; ++dx) at(x + dx, y + dy) = FILLED;
+            }
+        }
+
+        // Flood the exterior from the border; whatever stays EMPTY is a hole
+        std::vector<std::pair<long, long>> stack = {{minX, minY}};
+        at(minX, minY) = OUTSIDE;
+        while (!stack.empty()) {
+            auto [x, y] = stack.back();
+            stack.pop_back();
+            const long nx[] = {x + 1, x - 1, x, x};
+            const long ny[] = {y, y, y + 1, y - 1};
+            for (int k = 0; k < 4; ++k) {
+                if (nx[k] < minX || nx[k] > maxX || ny[k] < minY || ny[k] > maxY) continue;
+                if (at(nx[k], ny[k]) != EMPTY) continue;
+                at(nx[k], ny[k]) = OUTSIDE;
+                stack.emplace_back(nx[k], ny[k]);
+            }
+        }
+        auto inside = [&](long x, long y) {
+            return x >= minX && x <= maxX && y >= minY && y <= maxY && at(x, y) != OUTSIDE;
+        };
+
+        // Directed boundary edges with the interior on the left (counter-clockwise)
+        using Vertex = std::pair<long, long>;
+        std::map<Vertex, std::vector<Vertex>> outgoing;
+        for (long y = minY; y <= maxY; ++y) {
+            for (long x = minX; x <= maxX; ++x) {
+                if (!inside(x, y)) continue;
+                if (!inside(x, y - 1)) outgoing[{x, y}].push_back({x + 1, y});
+                if (!inside(x + 1, y)) outgoing[{x + 1, y}].push_back({x + 1, y + 1});
+                if (!inside(x, y + 1)) outgoing[{x + 1, y + 1}].push_back({x, y + 1});
+                if (!inside(x - 1, y)) outgoing[{x, y + 1}].push_back({x, y});
+            }
+        }
+
+        // Chain edges into rings, turning left at pinch vertices so rings stay simple
+        std::vector<Vertex> best;
+        double bestArea = 0.0;
+        while (!outgoing.empty()) {
+            std::vector<Vertex> ring;
+            Vertex current = outgoing.begin()->first;
+            const Vertex first = current;
+            long dirX = 0, dirY = 0;
+            while (true) {
+                auto it = outgoing.find(current);
+                if (it == outgoing.end()) break;
+                auto& options = it->second;
+                size_t pick = 0;
+                if (options.size() > 1 && (dirX || dirY)) {
+                    for (size_t k = 0; k < options.size(); ++k) {
+                        const long ox = options[k].first - current.first;
+                        const long oy = options[k].second - current.second;
+                        if (ox == -dirY && oy == dirX) { pick = k; break; }
+                    }
+                }
+                const Vertex next = options[pick];
+                options.erase(options.begin() + pick);
+                if (options.empty()) outgoing.erase(it);
+
+                // Drop collinear vertices
+                const long nx = next.first - current.first;
+                const long ny = next.second - current.second;
+                if (nx != dirX || ny != dirY) ring.push_back(current);
+                dirX = nx;
+                dirY = ny;
+                current = next;
+                if (current == first) break;
+            }
+
+            double area = 0.0;
+            for (size_t i = 0; i < ring.size(); ++i) {
+                const Vertex& a = ring[i];
+                const Vertex& b = ring[(i + 1) % ring.size()];
+                area += static_cast<double>(a.first) * b.second - static_cast<double>(b.first) * a.second;
+            }
+            if (area / 2 > bestArea) {
+                bestArea = area / 2;
+                best = std::move(ring);
+            }
+        }
+        if (best.empty()) return nullptr;
+
+        json ring = json::array();
+        for (const auto& [x, y] : best) {
+            ring.push_back({originLon + x * cellSize / metersPerDegLon, originLat + y * cellSize / metersPerDegLat});
+        }
+        ring.push_back(ring.front());
+        return json{{"type", "Polygon"}, {"coordinates", json::array({ring})}};
+    }
+
+private:
+    double originLat;
+    double originLon;
+    double cellSize;
+    double metersPerDegLat;
+    double metersPerDegLon;
+    std::vector<std::pair<long, long>> cells;
+};
+
+} // namespace
+
+json Graph::isochrone(const json& start, double budget, Weighting weighting, double cellSizeMeters) const {
+    if (!nodes.count(start["id"])) {
+        throw std::invalid_argument("Start node not found in graph");
+    }
+    if (!(budget >= 0)) {
+        throw std::invalid_argument("Budget must be non-negative");
+    }
+    if (cellSizeMeters != 0 &&
+        !(cellSizeMeters >= MIN_ISOCHRONE_CELL_METERS && cellSizeMeters <= MAX_ISOCHRONE_CELL_METERS)) {
+        throw std::invalid_argument("Cell size out of range");
+    }
+    const int64_t startId = start["id"];
+    const auto& weight = weights[static_cast<size_t>(weighting)];
+
+    // Dijkstra with an early cutoff; labels beyond the budget are never
+    // stored, so memory follows the reached area rather than the graph
+    std::unordered_map<int64_t, double> cost;
+    std::vector<int64_t> settled;
+    std::priority_queue<
+        std::pair<double, int64_t>,
+        std::vector<std::pair<double, int64_t>>,
+        std::greater<std::pair<double, int64_t>>
+    > pq;
+
+    cost[startId] = 0.0;
+    pq.push({0.0, startId});
+    while (!pq.empty()) {
+        auto [current, node] = pq.top();
+        pq.pop();
+        if (current > cost[node]) continue;
+        settled.push_back(node);
+
+        auto it = edges.find(node);
+        if (it == edges.end()) continue;
+        for (const auto& edge : it->second) {
+            const double next = current + weight[edge.id];
+            if (next > budget) continue;
+            auto [slot, inserted] = cost.try_emplace(edge.to, next);
+            if (inserted || next < slot->second) {
+                slot->second = next;
+                pq.push({next, edge.to});
+            }
+        }
+    }
+
+    const auto& origin = nodes.at(startId);
+    RasterOutline outline(origin.first, origin.second, cellSizeMeters > 0 ? cellSizeMeters : MIN_ISOCHRONE_CELL_METERS);
+
+    json reached = json::array();
+    json boundary = json::array();
+    for (int64_t node : settled) {
+        const double nodeCost = cost.at(node);
+        const auto& coords = nodes.at(node);
+        reached.push_back({
+            {"id", node},
+            {"lat", coords.first},
+            {"lon", coords.second},
+            {"cost", nodeCost}
+        });
+        if (cellSizeMeters > 0) outline.add(coords.first, coords.second);
+
+        auto it = edges.find(node);
+        if (it == edges.end()) continue;
+        for (const auto& edge : it->second) {
+            const double w = weight[edge.id];
+            if (std::isinf(w)) continue;
+            const auto& to = nodes.at(edge.to);
+
+            // Edges leaving the reached set are cut where the budget runs out
+            if (nodeCost + w > budget && !(cost.count(edge.to) && cost.at(edge.to) <= budget)) {
+                const double fraction = w > 0 ? (budget - nodeCost) / w : 0.0;
+                const double lat = coords.first + (to.first - coords.first) * fraction;
+                const double lon = coords.second + (to.second - coords.second) * fraction;
+                boundary.push_back({
+                    {"from", node},
+                    {"to", edge.to},
+                    {"fraction", fraction},
+                    {"lat", lat},
+                    {"lon", lon}
+                });
+                if (cellSizeMeters > 0) {
+                    outline.addSegment(coords.first, coords.second, lat, lon, edge.distance * fraction);
+                }
+            } else if (cellSizeMeters > 0) {
+                outline.addSegment(coords.first, coords.second, to.first, to.second, edge.distance);
+            }
+        }
+    }
+
+    return {
+        {"reached", reached},
+        {"boundary", boundary},
+        {"polygon", cellSizeMeters > 0 ? outline.polygon() : json(nullptr)}
+    };
+}
@@ -0,0 +1,199 @@
+#include "graph.hpp"
+#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+using QueueEntry = std::pair<double, int64_t>;
+using MinQueue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+struct Route {
+    std::vector<int64_t> sequence;
+    std::vector<double> prefix;  // weight from the start up to each node of sequence
+
+    double weight() const { return prefix.back(); }
+};
+
+} // namespace
+
+json Graph::kShortestPaths(const json& start, const json& end, size_t k, Weighting weighting,
+                           unsigned threads) const {
+    if (!nodes.count(start["id"]) || !nodes.count(end["id"]) || k == 0) {
+        return json::array();
+    }
+    const int64_t startId = start["id"];
+    const int64_t endId = end["id"];
+    const auto& weight = weights[static_cast<size_t>(weighting)];
+
+    // Reverse Dijkstra from the target over twin edges (id ^ 1). Its labels
+    // are exact remaining distances, so they serve as a perfect A* heuristic
+    // for every spur search and its tree yields the first path directly.
+    std::unordered_map<int64_t, double> toTarget = {{endId, 0.0}};
+    std::unordered_map<int64_t, int64_t> towardTarget;
+    {
+        MinQueue queue;
+        queue.push({0.0, endId});
+        while (!queue.empty()) {
+            auto [d, node] = queue.top();
+            queue.pop();
+            if (d > toTarget.at(node)) continue;
+            auto it = edges.find(node);
+            if (it == edges.end()) continue;
+            for (const auto& edge : it->second) {
+                const double w = weight[edge.id ^ 1];
+                if (std::isinf(w)) continue;
+                auto [slot, inserted] = toTarget.try_emplace(edge.to, d + w);
+                if (inserted || d + w < slot->second) {
+                    slot->second = d + w;
+                    towardTarget[edge.to] = node;
+                    queue.push({d + w, edge.to});
+                }
+            }
+        }
+    }
+    if (!toTarget.count(startId)) return json::array();
+
+    Route first;
+    for (int64_t at = startId; ; at = towardTarget.at(at)) {
+        first.sequence.push_back(at);
+        first.prefix.push_back(toTarget.at(startId) - toTarget.at(at));
+        if (at == endId) break;
+    }
+
+    // A* from a spur node to the target avoiding the root path's nodes and
+    // the edges already used by accepted paths sharing that root
+    auto spurSearch = [&](int64_t spur, double spurCost,
+                          const std::unordered_set<int64_t>& blockedNodes,
+                          const std::unordered_set<std::pair<int64_t, int64_t>, PairHash>& blockedEdges) {
+        std::unordered_map<int64_t, double> dist = {{spur, spurCost}};
+        std::unordered_map<int64_t, int64_t> parent;
+        MinQueue queue;
+        queue.push({spurCost + toTarget.at(spur), spur});
+        while (!queue.empty()) {
+            auto [estimate, node] = queue.top();
+            queue.pop();
+            const double d = dist.at(node);
+            if (estimate > d + toTarget.at(node)) continue;
+            if (node == endId) break;
+
+            auto it = edges.find(node);
+            if (it == edges.end()) continue;
+            for (const auto& edge : it->second) {
+                const double w = weight[edge.id];
+                if (std::isinf(w) || blockedNodes.count(edge.to) || blockedEdges.count({node, edge.to})) continue;
+                auto remaining = toTarget.find(edge.to);
+                if (remaining == toTarget.end()) continue;
+                auto [slot, inserted] = dist.try_emplace(edge.to, d + w);
+                if (inserted || d + w < slot->second) {
+                    slot->second = d + w;
+                    parent[edge.to] = node;
+                    queue.push({d + w + remaining->second, edge.to});
+                }
+            }
+        }
+
+        Route spurPath;
+        if (!dist.count(endId)) return spurPath;
+        for (int64_t at = endId; ; at = parent.at(at)) {
+            spurPath.sequence.push_back(at);
+            spurPath.prefix.push_back(dist.at(at));
+            if (at == spur) break;
+        }
+        std::reverse(spurPath.sequence.begin(), spurPath.sequence.end());
+        std::reverse(spurPath.prefix.begin(), spurPath.prefix.end());
+        return spurPath;
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Yen's algorithm. Candidates are ordered by weight and trimmed to the
+    // number of paths still missing, since nothing beyond that can ever be
+    // accepted. Duplicates are recognised by node sequence alone: the same
+    // path found from different spur nodes sums its weight in a different
+    // order and may differ in the last bit.
+    std::vector<Route> accepted = {first};
+    std::multimap<double, Route> candidates;
+    std::set<std::vector<int64_t>> queuedSequences;
+    std::set<std::vector<int64_t>> acceptedSequences = {first.sequence};
+
+    while (accepted.size() < k) {
+        const Route& last = accepted.back();
+        const size_t spurCount = last.sequence.size() - 1;
+        if (spurCount == 0) break;
+        std::vector<Route> found(spurCount);
+
+        // Spur searches of one round are independent; threads take spur indices in turn
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next++; i < spurCount; i = next++) {
+                std::unordered_set<int64_t> blockedNodes(last.sequence.begin(), last.sequence.begin() + i);
+                std::unordered_set<std::pair<int64_t, int64_t>, PairHash> blockedEdges;
+                for (const auto& route : accepted) {
+                    if (route.sequence.size() > i + 1 &&
+                        std::equal(last.sequence.begin(), last.sequence.begin() + i + 1, route.sequence.begin())) {
+                        blockedEdges.insert({route.sequence[i], route.sequence[i + 1]});
+                    }
+                }
+
+                Route spurPath = spurSearch(last.sequence[i], last.prefix[i], blockedNodes, blockedEdges);
+                if (spurPath.sequence.empty()) continue;
+
+                Route& candidate = found[i];
+                candidate.sequence.assign(last.sequence.begin(), last.sequence.begin() + i);
+                candidate.prefix.assign(last.prefix.begin(), last.prefix.begin() + i);
+                candidate.sequence.insert(candidate.sequence.end(), spurPath.sequence.begin(), spurPath.sequence.end());
+                candidate.prefix.insert(candidate.prefix.end(), spurPath.prefix.begin(), spurPath.prefix.end());
+            }
+        };
+        std::vector<std::thread> pool;
+        const unsigned poolSize = static_cast<unsigned>(std::min<size_t>(threads, spurCount)) - 1;
+        for (unsigned t = 0; t < poolSize; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& thread : pool) thread.join();
+
+        const size_t missing = k - accepted.size();
+        for (auto& route : found) {
+            if (route.sequence.empty() || acceptedSequences.count(route.sequence) ||
+                !queuedSequences.insert(route.sequence).second) {
+                continue;
+            }
+            const double routeWeight = route.weight();
+            candidates.emplace(routeWeight, std::move(route));
+            if (candidates.size() > missing) {
+                auto worst = std::prev(candidates.end());
+                queuedSequences.erase(worst->second.sequence);
+                candidates.erase(worst);
+            }
+        }
+
+        // Cheapest candidate not accepted yet
+        bool added = false;
+        while (!candidates.empty() && !added) {
+            auto best = candidates.begin();
+            queuedSequences.erase(best->second.sequence);
+            if (acceptedSequences.insert(best->second.sequence).second) {
+                accepted.push_back(std::move(best->second));
+                added = true;
+            }
+            candidates.erase(best);
+        }
+        if (!added) break;
+    }
+
+    json result = json::array();
+    for (const auto& route : accepted) {
+        result.push_back({
+            {"path", buildPath(route.sequence)},
+            {"weight", route.weight()}
+        });
+    }
+    return result;
+}
@@ -2,9 +2,51 @@
 #include "graph.hpp"
 #include "routes.hpp"
 #include "crow/middlewares/cors.h"
+#include "store.hpp"
+#include <async_log/log.hpp>
+#include <cstdlib>
+#include <memory>
+
+// Crow's own messages, sent through the structured log instead of straight to std::cerr
+class AsyncLogHandler : public crow::ILogHandler {
+public:
+    void log(const std::string& message, crow::LogLevel level) override {
+        switch (level) {
+            case crow::LogLevel::Debug:
+                async_log::debug(message, {{"source", "crow"}});
+                break;
+            case crow::LogLevel::Info:
+                async_log::info(message, {{"source", "crow"}});
+                break;
+            case crow::LogLevel::Warning:
+                async_log::warn(message, {{"source", "crow"}});
+                break;
+            default:
+                async_log::error(message, {{"source", "crow"}});
+        }
+    }
+};
+
+// Crow's threshold matching ours, so it does not format messages that would be dropped
+crow::LogLevel crowLevel(async_log::Level level) {
+    switch (level) {
+        case async_log::Level::Debug: return crow::LogLevel::Debug;
+        case async_log::Level::Info: return crow::LogLevel::Info;
+        case async_log::Level::Warn: return crow::LogLevel::Warning;
+        case async_log::Level::Error: return crow::LogLevel::Error;
+    }
+    return crow::LogLevel::Info;
+}
 
 int main() {
+    // Structured logs go to stdout from a background thread; see async_log for LOG_LEVEL and friends
+    const async_log::Options logOptions = async_log::optionsFromEnvironment();
+    async_log::start(logOptions);
+    AsyncLogHandler crowLog;
+    crow::logger::setHandler(&crowLog);
+
     crow::App<crow::CORSHandler> app;
+    app.loglevel(crowLevel(logOptions.level));
     
     // CORS configuration
     auto& cors = app.get_middleware<crow::CORSHandler>();
@@ -21,8 +63,29 @@ int main() {
     // Initialize graph
     Graph graph;
 
+    // Optional on-disk store of Overpass responses; OVERPASS_OFFLINE=1 serves
+    // only from the store, e.g. a fixture directory for tests and benchmarks
+    if (const char* tileDir = std::getenv("OVERPASS_TILE_STORE")) {
+        OverpassTileStore::Options options;
+        if (const char* maxAge = std::getenv("OVERPASS_TILE_MAX_AGE")) {
+            options.maxAgeSeconds = std::atoll(maxAge);
+        }
+        if (const char* offline = std::getenv("OVERPASS_OFFLINE")) {
+            options.offline = std::string(offline) == "1";
+        }
+        OverpassDataFetcher::setTileStore(std::make_shared<OverpassTileStore>(tileDir, options));
+    }
+
+    // Upstream Overpass requests run on their own small I/O pool, and the
+    // parsing and searching on their responses on a separate compute pool.
+    // Past 32 distinct fetches or 256 waiting requests, requests get 503.
+    AsyncOverpassFetcher fetcher(2, 2, 32, 256);
+
+    // Searches streamed to the visualiser over /exploration
+    ExplorationHub explorations;
+
     // Set up routes
-    setupRoutes(app, graph);
+    setupRoutes(app, graph, fetcher, explorations);
 
     // Configure and run the application
     app.port(8080)
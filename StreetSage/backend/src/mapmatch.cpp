@@ -0,0 +1,335 @@
+#include "mapmatch.hpp"
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+MapMatcher::MapMatcher(const Graph& graph, Weighting weighting, Options options) : options(options) {
+    if (!(options.searchRadius > 0) || !(options.gpsSigma > 0) || !(options.beta > 0)) {
+        throw std::invalid_argument("Map matching radius, sigma and beta must be positive");
+    }
+
+    const auto& graphNodes = graph.getNodes();
+    std::unordered_map<int64_t, uint32_t> indexOf;
+    indexOf.reserve(graphNodes.size());
+    for (const auto& [id, coords] : graphNodes) {
+        indexOf[id] = static_cast<uint32_t>(nodeIds.size());
+        nodeIds.push_back(id);
+        originLat += coords.first;
+        originLon += coords.second;
+    }
+    if (!nodeIds.empty()) {
+        originLat /= nodeIds.size();
+        originLon /= nodeIds.size();
+    }
+    metersPerDegLon = 111320.0 * std::cos(originLat * M_PI / 180);
+
+    nodeX.resize(nodeIds.size());
+    nodeY.resize(nodeIds.size());
+    for (size_t i = 0; i < nodeIds.size(); ++i) {
+        const auto& coords = graphNodes.at(nodeIds[i]);
+        project(coords.first, coords.second, nodeX[i], nodeY[i]);
+    }
+
+    // Directed edges by Edge::id; both directions of a segment are always present
+    size_t edgeCount = 0;
+    for (const auto& [_, edgeList] : graph.getEdges()) {
+        for (const auto& edge : edgeList) edgeCount = std::max<size_t>(edgeCount, edge.id + 1);
+    }
+    edgeCount += edgeCount % 2;
+    edgeFrom.assign(edgeCount, 0);
+    edgeTo.assign(edgeCount, 0);
+    edgeLength.assign(edgeCount, 0.0f);
+    edgeAllowed.assign(edgeCount, false);
+    outOffsets.assign(nodeIds.size() + 1, 0);
+    for (const auto& [src, edgeList] : graph.getEdges()) {
+        const uint32_t u = indexOf.at(src);
+        for (const auto& edge : edgeList) {
+            edgeFrom[edge.id] = u;
+            edgeTo[edge.id] = indexOf.at(edge.to);
+            edgeLength[edge.id] = static_cast<float>(edge.distance);
+            edgeAllowed[edge.id] = !std::isinf(graph.getWeight(weighting, edge));
+            if (edgeAllowed[edge.id]) ++outOffsets[u + 1];
+        }
+    }
+    for (size_t i = 0; i < nodeIds.size(); ++i) outOffsets[i + 1] += outOffsets[i];
+    outEdges.resize(outOffsets.back());
+    std::vector<uint32_t> fill(outOffsets.begin(), outOffsets.end() - 1);
+    for (uint32_t e = 0; e < edgeCount; ++e) {
+        if (edgeAllowed[e]) outEdges[fill[edgeFrom[e]]++] = e;
+    }
+
+    // Grid index: each segment goes into every cell its bounding box touches
+    const double cell = options.searchRadius;
+    std::vector<std::pair<int64_t, uint32_t>> entries;
+    for (uint32_t segment = 0; segment < edgeCount / 2; ++segment) {
+        const uint32_t a = edgeFrom[2 * segment], b = edgeTo[2 * segment];
+        if (!edgeAllowed[2 * segment] && !edgeAllowed[2 * segment + 1]) continue;
+        const long x0 = static_cast<long>(std::floor(std::min(nodeX[a], nodeX[b]) / cell));
+        const long x1 = static_cast<long>(std::floor(std::max(nodeX[a], nodeX[b]) / cell));
+        const long y0 = static_cast<long>(std::floor(std::min(nodeY[a], nodeY[b]) / cell));
+        const long y1 = static_cast<long>(std::floor(std::max(nodeY[a], nodeY[b]) / cell));
+        for (long cx = x0; cx <= x1; ++cx) {
+            for (long cy = y0; cy <= y1; ++cy) entries.emplace_back(cellKey(cx, cy), segment);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    cellSegments.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ) {
+        const int64_t key = entries[i].first;
+        const uint32_t first = static_cast<uint32_t>(cellSegments.size());
+        for (; i < entries.size() && entries[i].first == key; ++i) cellSegments.push_back(entries[i].second);
+        cells[key] = {first, static_cast<uint32_t>(cellSegments.size()) - first};
+    }
+}
+
+void MapMatcher::project(double lat, double lon, double& x, double& y) const {
+    x = (lon - originLon) * metersPerDegLon;
+    y = (lat - originLat) * metersPerDegLat;
+}
+
+void MapMatcher::unproject(double x, double y, double& lat, double& lon) const {
+    lat = originLat + y / metersPerDegLat;
+    lon = originLon + x / metersPerDegLon;
+}
+
+std::vector<MapMatcher::Candidate> MapMatcher::candidates(double x, double y) const {
+    const double radius = options.searchRadius;
+    std::vector<uint32_t> segments;
+    const long x0 = static_cast<long>(std::floor((x - radius) / radius));
+    const long y0 = static_cast<long>(std::floor((y - radius) / radius));
+    for (long cx = x0; cx <= x0 + 2; ++cx) {
+        for (long cy = y0; cy <= y0 + 2; ++cy) {
+            auto it = cells.find(cellKey(cx, cy));
+            if (it == cells.end()) continue;
+            const auto [first, count] = it->second;
+            segments.insert(segments.end(), cellSegments.begin() + first, cellSegments.begin() + first + count);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+    std::vector<Candidate> result;
+    for (uint32_t segment : segments) {
+        const uint32_t a = edgeFrom[2 * segment], b = edgeTo[2 * segment];
+        const double dx = nodeX[b] - nodeX[a], dy = nodeY[b] - nodeY[a];
+        const double lengthSq = dx * dx + dy * dy;
+        const double t = lengthSq > 0
+            ? std::clamp(((x - nodeX[a]) * dx + (y - nodeY[a]) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+        const double error = std::hypot(nodeX[a] + t * dx - x, nodeY[a] + t * dy - y);
+        if (error > radius) continue;
+
+        // Both directions are candidates where allowed; the reverse edge runs from b to a
+        if (edgeAllowed[2 * segment]) result.push_back({2 * segment, t, error});
+        if (edgeAllowed[2 * segment + 1]) result.push_back({2 * segment + 1, 1 - t, error});
+    }
+
+    if (result.size() > options.maxCandidates) {
+        std::partial_sort(result.begin(), result.begin() + options.maxCandidates, result.end(),
+                          [](const Candidate& l, const Candidate& r) { return l.error < r.error; });
+        result.resize(options.maxCandidates);
+    }
+    return result;
+}
+
+MapMatcher::MatchedPoint MapMatcher::toMatched(size_t index, uint32_t edge, double fraction, double error) const {
+    const uint32_t a = edgeFrom[edge], b = edgeTo[edge];
+    MatchedPoint point{index, true};
+    point.from = nodeIds[a];
+    point.to = nodeIds[b];
+    point.fraction = fraction;
+    point.error = error;
+    unproject(nodeX[a] + (nodeX[b] - nodeX[a]) * fraction, nodeY[a] + (nodeY[b] - nodeY[a]) * fraction,
+              point.lat, point.lon);
+    return point;
+}
+
+// Bounded Dijkstra from a node over allowed edges. Results are kept for the
+// next step, where the vehicle usually still sits on the same edges.
+const std::unordered_map<uint32_t, double>& MapMatcher::Session::search(uint32_t source, double limit) {
+    auto cached = searches.find(source);
+    if (cached != searches.end() && cached->second.limit >= limit) return cached->second.dist;
+    auto previous = previousSearches.find(source);
+    if (previous != previousSearches.end() && previous->second.limit >= limit) {
+        RouteSearch& reused = searches[source] = std::move(previous->second);
+        return reused.dist;
+    }
+
+    RouteSearch& result = searches[source];
+    result.limit = limit;
+    result.dist.clear();
+    result.dist[source] = 0.0;
+
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.push({0.0, source});
+    while (!queue.empty()) {
+        auto [d, node] = queue.top();
+        queue.pop();
+        if (d > result.dist[node]) continue;
+        for (uint32_t i = matcher.outOffsets[node]; i < matcher.outOffsets[node + 1]; ++i) {
+            const uint32_t edge = matcher.outEdges[i];
+            const double next = d + matcher.edgeLength[edge];
+            if (next > limit) continue;
+            auto [slot, inserted] = result.dist.try_emplace(matcher.edgeTo[edge], next);
+            if (inserted || next < slot->second) {
+                slot->second = next;
+                queue.push({next, matcher.edgeTo[edge]});
+            }
+        }
+    }
+    return result.dist;
+}
+
+std::vector<MapMatcher::MatchedPoint> MapMatcher::Session::push(double lat, double lon) {
+    const size_t index = nextIndex++;
+    double x, y;
+    matcher.project(lat, lon, x, y);
+    const auto found = matcher.candidates(x, y);
+
+    std::vector<MatchedPoint> out;
+    // Points without candidates are reported unmatched once their predecessor is decided
+    if (found.empty()) {
+        if (lattice.size() == emitted) return {MatchedPoint{index, false}};
+        lattice.back().skipped.push_back(index);
+        return out;
+    }
+
+    const double sigma = matcher.options.gpsSigma;
+    Column column{index, {}, {}};
+    for (const auto& candidate : found) {
+        const double emission = -0.5 * (candidate.error / sigma) * (candidate.error / sigma);
+        column.states.push_back({candidate.edge, candidate.fraction, candidate.error, emission, -1});
+    }
+
+    if (!lattice.empty()) {
+        const Column& prev = lattice.back();
+        const double straight = std::hypot(x - lastX, y - lastY);
+        const double limit = straight * matcher.options.maxRouteFactor + 2 * matcher.options.searchRadius;
+        previousSearches = std::move(searches);
+        searches.clear();
+
+        std::vector<State> next = column.states;
+        for (auto& state : next) state.score = -INF;
+        for (size_t i = 0; i < prev.states.size(); ++i) {
+            const State& from = prev.states[i];
+            const double fromLength = matcher.edgeLength[from.edge];
+            const auto& dist = search(matcher.edgeTo[from.edge], limit);
+            for (size_t j = 0; j < next.size(); ++j) {
+                const State& to = column.states[j];
+                double route;
+                if (to.edge == from.edge && to.fraction >= from.fraction) {
+                    route = (to.fraction - from.fraction) * fromLength;
+                } else {
+                    auto it = dist.find(matcher.edgeFrom[to.edge]);
+                    if (it == dist.end()) continue;
+                    route = (1 - from.fraction) * fromLength + it->second + to.fraction * matcher.edgeLength[to.edge];
+                }
+                if (route > limit) continue;
+                const double score = from.score - std::abs(route - straight) / matcher.options.beta + to.score;
+                if (score > next[j].score) {
+                    next[j].score = score;
+                    next[j].back = static_cast<int32_t>(i);
+                }
+            }
+        }
+
+        next.erase(std::remove_if(next.begin(), next.end(), [](const State& s) { return std::isinf(s.score); }),
+                   next.end());
+        if (next.empty()) {
+            // HMM break: no route explains the jump, so decide the run so far and start over
+            out = flush();
+            searches.clear();
+        } else {
+            column.states = std::move(next);
+        }
+    }
+    lattice.push_back(std::move(column));
+    lastX = x;
+    lastY = y;
+
+    // Online Viterbi: follow back pointers of all live states until they meet;
+    // everything up to the meeting column is final
+    std::vector<int32_t> live(lattice.back().states.size());
+    for (size_t i = 0; i < live.size(); ++i) live[i] = static_cast<int32_t>(i);
+    for (size_t c = lattice.size(); c-- > emitted; ) {
+        std::sort(live.begin(), live.end());
+        live.erase(std::unique(live.begin(), live.end()), live.end());
+        if (live.size() == 1) {
+            auto decided = decide(c, live.front());
+            out.insert(out.end(), decided.begin(), decided.end());
+            break;
+        }
+        if (c == 0) break;
+        for (auto& state : live) state = lattice[c].states[state].back;
+    }
+    return out;
+}
+
+std::vector<MapMatcher::MatchedPoint> MapMatcher::Session::decide(size_t upTo, int32_t state) {
+    std::vector<MatchedPoint> out;
+    std::vector<int32_t> chosen(upTo + 1);
+    chosen[upTo] = state;
+    for (size_t c = upTo; c > emitted; --c) chosen[c - 1] = lattice[c].states[chosen[c]].back;
+
+    for (size_t c = emitted; c <= upTo; ++c) {
+        const State& s = lattice[c].states[chosen[c]];
+        out.push_back(matcher.toMatched(lattice[c].index, s.edge, s.fraction, s.error));
+        for (size_t skipped : lattice[c].skipped) out.push_back(MatchedPoint{skipped, false});
+    }
+
+    // Keep the decided column itself, reduced to its chosen state: the next column points into it
+    for (size_t c = 0; c < upTo; ++c) lattice.pop_front();
+    Column& decided = lattice.front();
+    decided.states = {decided.states[state]};
+    decided.skipped.clear();
+    if (lattice.size() > 1) {
+        for (auto& next : lattice[1].states) next.back = 0;
+    }
+    emitted = 1;
+    return out;
+}
+
+std::vector<MapMatcher::MatchedPoint> MapMatcher::Session::flush() {
+    std::vector<MatchedPoint> out;
+    if (lattice.size() > emitted) {
+        const auto& last = lattice.back().states;
+        const auto best = std::max_element(last.begin(), last.end(),
+                                           [](const State& l, const State& r) { return l.score < r.score; });
+        out = decide(lattice.size() - 1, static_cast<int32_t>(best - last.begin()));
+    }
+    lattice.clear();
+    emitted = 0;
+    return out;
+}
+
+std::vector<MapMatcher::MatchedPoint> MapMatcher::Session::finish() {
+    return flush();
+}
+
+std::vector<MapMatcher::MatchedPoint> MapMatcher::match(const json& trace) const {
+    if (!trace.is_array()) {
+        throw std::invalid_argument("Trace must be an array of {lat, lon} points");
+    }
+    Session session(*this);
+    std::vector<MatchedPoint> result;
+    result.reserve(trace.size());
+    for (const auto& point : trace) {
+        if (!point.is_object() || !point.contains("lat") || !point.contains("lon") ||
+            !point["lat"].is_number() || !point["lon"].is_number()) {
+            throw std::invalid_argument("Each trace point must contain numeric 'lat' and 'lon'");
+        }
+        auto decided = session.push(point["lat"].get<double>(), point["lon"].get<double>());
+        result.insert(result.end(), decided.begin(), decided.end());
+    }
+    auto rest = session.finish();
+    result.insert(result.end(), rest.begin(), rest.end());
+    return result;
+}
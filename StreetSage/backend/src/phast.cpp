@@ -0,0 +1,286 @@
+#include "phast.hpp"
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <limits>
+#include <tuple>
+
+namespace {
+
+using Adjacency = std::vector<std::vector<std::pair<uint32_t, float>>>;
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+// Witness searches give up after this many settled nodes; a missed witness
+// only costs an unnecessary shortcut, never a wrong distance
+constexpr int WITNESS_SETTLE_LIMIT = 200;
+
+// Bounded Dijkstra used to prove shortcuts unnecessary. Distances live in a
+// graph-sized array reset by timestamps so each search only pays for what it touches.
+class WitnessSearch {
+public:
+    explicit WitnessSearch(size_t nodeCount) : dist(nodeCount, INF), stamp(nodeCount, 0) {}
+
+    void run(const Adjacency& out, const std::vector<bool>& contracted,
+             uint32_t source, uint32_t skipped, float limit) {
+        ++round;
+        using Entry = std::pair<float, uint32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        set(source, 0.0f);
+        pq.push({0.0f, source});
+        int settled = 0;
+        while (!pq.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > get(u)) continue;
+            if (d > limit) break;
+            ++settled;
+            for (const auto& [x, w] : out[u]) {
+                if (contracted[x] || x == skipped) continue;
+                const float nd = d + w;
+                if (nd < get(x)) {
+                    set(x, nd);
+                    pq.push({nd, x});
+                }
+            }
+        }
+    }
+
+    float get(uint32_t node) const { return stamp[node] == round ? dist[node] : INF; }
+
+private:
+    std::vector<float> dist;
+    std::vector<uint32_t> stamp;
+    uint32_t round = 0;
+
+    void set(uint32_t node, float value) {
+        stamp[node] = round;
+        dist[node] = value;
+    }
+};
+
+struct ContractionResult {
+    std::vector<std::tuple<uint32_t, uint32_t, float>> shortcuts;
+    int removedEdges = 0;
+};
+
+// Shortcuts needed to contract v, without applying them
+ContractionResult simulate(const Adjacency& out, const Adjacency& in, const std::vector<bool>& contracted,
+                           WitnessSearch& witness, uint32_t v) {
+    ContractionResult result;
+    float maxOut = 0.0f;
+    for (const auto& [x, w] : out[v]) {
+        if (contracted[x]) continue;
+        maxOut = std::max(maxOut, w);
+        ++result.removedEdges;
+    }
+    for (const auto& [u, wu] : in[v]) {
+        if (contracted[u]) continue;
+        ++result.removedEdges;
+        if (u == v) continue;
+
+        witness.run(out, contracted, u, v, wu + maxOut);
+        for (const auto& [x, wx] : out[v]) {
+            if (contracted[x] || x == u || x == v) continue;
+            if (witness.get(x) > wu + wx) {
+                result.shortcuts.emplace_back(u, x, wu + wx);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+PhastEngine::PhastEngine(const Graph& graph, Weighting weighting) {
+    // Dense snapshot of the selected weighting
+    const auto& graphNodes = graph.getNodes();
+    nodeIds.reserve(graphNodes.size());
+    indexOf.reserve(graphNodes.size());
+    for (const auto& [id, _] : graphNodes) {
+        indexOf[id] = static_cast<uint32_t>(nodeIds.size());
+        nodeIds.push_back(id);
+    }
+    const size_t n = nodeIds.size();
+
+    Adjacency out(n), in(n);
+    std::vector<std::tuple<uint32_t, uint32_t, float>> allEdges;
+    for (const auto& [src, edgeList] : graph.getEdges()) {
+        const uint32_t u = indexOf.at(src);
+        for (const auto& edge : edgeList) {
+            const float w = static_cast<float>(graph.getWeight(weighting, edge));
+            if (std::isinf(w) || edge.to == src) continue;
+            const uint32_t x = indexOf.at(edge.to);
+            out[u].push_back({x, w});
+            in[x].push_back({u, w});
+            allEdges.emplace_back(u, x, w);
+        }
+    }
+
+    std::vector<uint32_t> rank;
+    contract(out, in, rank, allEdges);
+
+    // Sweep order is descending rank
+    position.resize(n);
+    for (uint32_t v = 0; v < n; ++v) position[v] = static_cast<uint32_t>(n - 1 - rank[v]);
+
+    // Every edge points either up or down the hierarchy; bucket both ways by sweep position
+    std::vector<uint32_t> upCount(n + 1, 0), downCount(n + 1, 0);
+    for (const auto& [u, x, w] : allEdges) {
+        if (rank[u] < rank[x]) ++upCount[position[u] + 1];
+        else ++downCount[position[x] + 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        upCount[i + 1] += upCount[i];
+        downCount[i + 1] += downCount[i];
+    }
+    upOffsets = upCount;
+    downOffsets = downCount;
+    upTargets.resize(upOffsets[n]);
+    upWeights.resize(upOffsets[n]);
+    downSources.resize(downOffsets[n]);
+    downWeights.resize(downOffsets[n]);
+    for (const auto& [u, x, w] : allEdges) {
+        if (rank[u] < rank[x]) {
+            const uint32_t slot = upCount[position[u]]++;
+            upTargets[slot] = position[x];
+            upWeights[slot] = w;
+        } else {
+            const uint32_t slot = downCount[position[x]]++;
+            downSources[slot] = position[u];
+            downWeights[slot] = w;
+        }
+    }
+
+    // Relax downward edges in source order for better locality within each bucket
+    for (size_t p = 0; p < n; ++p) {
+        std::vector<std::pair<uint32_t, float>> bucket;
+        for (uint32_t e = downOffsets[p]; e < downOffsets[p + 1]; ++e) bucket.push_back({downSources[e], downWeights[e]});
+        std::sort(bucket.begin(), bucket.end());
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            downSources[downOffsets[p] + i] = bucket[i].first;
+            downWeights[downOffsets[p] + i] = bucket[i].second;
+        }
+    }
+}
+
+void PhastEngine::contract(Adjacency& out, Adjacency& in, std::vector<uint32_t>& rank,
+                           std::vector<std::tuple<uint32_t, uint32_t, float>>& allEdges) {
+    const size_t n = out.size();
+    rank.assign(n, 0);
+    std::vector<bool> contracted(n, false);
+    std::vector<int> contractedNeighbors(n, 0);
+    WitnessSearch witness(n);
+
+    // Edge difference plus a term that spreads contraction evenly over the graph
+    auto priority = [&](uint32_t v) {
+        ContractionResult result = simulate(out, in, contracted, witness, v);
+        return static_cast<int>(result.shortcuts.size()) - result.removedEdges + contractedNeighbors[v];
+    };
+
+    using Entry = std::pair<int, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (uint32_t v = 0; v < n; ++v) queue.push({priority(v), v});
+
+    uint32_t nextRank = 0;
+    while (!queue.empty()) {
+        auto [prio, v] = queue.top();
+        queue.pop();
+        if (contracted[v]) continue;
+
+        // Lazy update: re-evaluate and requeue if the node is no longer the cheapest
+        const int current = priority(v);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.push({current, v});
+            continue;
+        }
+
+        ContractionResult result = simulate(out, in, contracted, witness, v);
+        for (const auto& [u, x, w] : result.shortcuts) {
+            out[u].push_back({x, w});
+            in[x].push_back({u, w});
+            allEdges.emplace_back(u, x, w);
+        }
+        shortcutCount += result.shortcuts.size();
+
+        contracted[v] = true;
+        rank[v] = nextRank++;
+        for (const auto& [x, _] : out[v]) ++contractedNeighbors[x];
+        for (const auto& [u, _] : in[v]) ++contractedNeighbors[u];
+
+        // Drop edges to contracted nodes so later witness searches stay small
+        auto prune = [&](std::vector<std::pair<uint32_t, float>>& list) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [&](const auto& e) { return contracted[e.first]; }),
+                       list.end());
+        };
+        for (const auto& [x, _] : out[v]) if (!contracted[x]) prune(in[x]);
+        for (const auto& [u, _] : in[v]) if (!contracted[u]) prune(out[u]);
+    }
+}
+
+template <int Lanes>
+void PhastEngine::sweep(const std::vector<uint32_t>& sourcePositions, std::vector<float>& dist) const {
+    const size_t n = nodeIds.size();
+    dist.assign(n * Lanes, INF);
+
+    // Upward phase: a small Dijkstra per lane over edges toward higher ranks
+    using Entry = std::pair<float, uint32_t>;
+    for (size_t lane = 0; lane < sourcePositions.size(); ++lane) {
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        dist[sourcePositions[lane] * Lanes + lane] = 0.0f;
+        pq.push({0.0f, sourcePositions[lane]});
+        while (!pq.empty()) {
+            auto [d, p] = pq.top();
+            pq.pop();
+            if (d > dist[p * Lanes + lane]) continue;
+            for (uint32_t e = upOffsets[p]; e < upOffsets[p + 1]; ++e) {
+                const float nd = d + upWeights[e];
+                float& slot = dist[upTargets[e] * Lanes + lane];
+                if (nd < slot) {
+                    slot = nd;
+                    pq.push({nd, upTargets[e]});
+                }
+            }
+        }
+    }
+
+    // Downward phase: one linear pass in descending rank, all lanes at once
+    float* base = dist.data();
+    for (size_t p = 0; p < n; ++p) {
+        float* target = base + p * Lanes;
+        for (uint32_t e = downOffsets[p]; e < downOffsets[p + 1]; ++e) {
+            const float* source = base + static_cast<size_t>(downSources[e]) * Lanes;
+            const float w = downWeights[e];
+            for (int k = 0; k < Lanes; ++k) {
+                target[k] = std::min(target[k], source[k] + w);
+            }
+        }
+    }
+}
+
+std::vector<float> PhastEngine::distancesFrom(int64_t source) const {
+    std::vector<float> dist;
+    sweep<1>({position[indexOf.at(source)]}, dist);
+
+    std::vector<float> result(nodeIds.size());
+    for (size_t v = 0; v < nodeIds.size(); ++v) result[v] = dist[position[v]];
+    return result;
+}
+
+std::vector<std::vector<float>> PhastEngine::distancesFrom(const std::vector<int64_t>& sources) const {
+    std::vector<std::vector<float>> result(sources.size(), std::vector<float>(nodeIds.size()));
+    std::vector<float> dist;
+    for (size_t first = 0; first < sources.size(); first += LANES) {
+        const size_t count = std::min<size_t>(LANES, sources.size() - first);
+        std::vector<uint32_t> sourcePositions;
+        for (size_t k = 0; k < count; ++k) sourcePositions.push_back(position[indexOf.at(sources[first + k])]);
+
+        sweep<LANES>(sourcePositions, dist);
+        for (size_t k = 0; k < count; ++k) {
+            auto& row = result[first + k];
+            for (size_t v = 0; v < nodeIds.size(); ++v) row[v] = dist[position[v] * LANES + k];
+        }
+    }
+    return result;
+}
@@ -1,13 +1,652 @@
 #include "routes.hpp"
 #include "api.hpp"
+#include "arena.hpp"
 #include "graph.hpp"
+#include "phast.hpp"
+#include "mapmatch.hpp"
 #include "json.hpp"
+#include <async_log/log.hpp>
 #include <algorithm>  
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
-void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph) {
+namespace {
+
+// The graph is shared by every request; loads and searches must not interleave
+std::mutex graphMutex;
+
+// Finish an asynchronous handler with the given response
+void reply(crow::response& res, crow::response&& result) {
+    res = std::move(result);
+    res.end();
+}
+
+// Answer for requests the Overpass fetcher has no room for
+crow::response busy() {
+    return crow::response(503, "Server is busy, try again later");
+}
+
+// Validate a [{latitude, longitude}, {latitude, longitude}] pair into a bounding box
+bool parseBoundingBox(const json& corners, BoundingBox& bbox, std::string& error) {
+    // Validate request body is an array with exactly 2 elements
+    if (!corners.is_array() || corners.size() != 2) {
+        error = "Request body must be an array with exactly 2 coordinate objects";
+        return false;
+    }
+
+    // Validate coordinates
+    for (const auto& item : corners) {
+        if (!item.contains("latitude") || !item.contains("longitude")) {
+            error = "Each coordinate object must contain 'latitude' and 'longitude'";
+            return false;
+        }
+        if (!item["latitude"].is_number() || !item["longitude"].is_number()) {
+            error = "Latitude and longitude must be numeric values";
+            return false;
+        }
+        
+        // Validate coordinate ranges
+        double lat = item["latitude"].get<double>();
+        double lon = item["longitude"].get<double>();
+        if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
+            error = "Coordinates out of valid range";
+            return false;
+        }
+    }
+
+    // Create bounding box
+    bbox = BoundingBox{
+        std::min(corners[0]["latitude"].get<double>(), corners[1]["latitude"].get<double>()),
+        std::min(corners[0]["longitude"].get<double>(), corners[1]["longitude"].get<double>()),
+        std::max(corners[0]["latitude"].get<double>(), corners[1]["latitude"].get<double>()),
+        std::max(corners[0]["longitude"].get<double>(), corners[1]["longitude"].get<double>())
+    };
+    return true;
+}
+
+// Routing options of a /direct-path request
+struct PathOptions {
+    Weighting weighting = Weighting::Distance;
+    std::optional<TurnCosts> turnCosts;
+    std::optional<double> departureTime;
+    int utcOffset = 0;
+    std::optional<AlternativeOptions> alternatives;
+    std::optional<SimplifyOptions> simplify;
+    std::optional<double> simplifyZoom;  // tolerance is one pixel at this zoom when set
+};
+
+bool parsePathOptions(const json& body, PathOptions& options, std::string& error) {
+    // Optional departure timestamp switches to time-dependent routing,
+    // optional turn-costs to edge-based routing
+    if (body.contains("departure-time") && body.contains("turn-costs")) {
+        error = "departure-time and turn-costs cannot be combined";
+        return false;
+    }
+
+    // Routing profile picks one of the graph's weight arrays
+    if (body.contains("profile")) {
+        if (!body["profile"].is_string()) {
+            error = "profile must be one of \"distance\", \"car\" or \"bike\"";
+            return false;
+        }
+        try {
+            options.weighting = parseWeighting(body["profile"].get<std::string>());
+        } catch (const std::invalid_argument& e) {
+            error = e.what();
+            return false;
+        }
+    }
+
+    if (body.contains("turn-costs")) {
+        const json& turnCosts = body["turn-costs"];
+        if (!turnCosts.is_boolean() && !turnCosts.is_object()) {
+            error = "turn-costs must be true or an object with penalties in metres";
+            return false;
+        }
+        if (turnCosts != false) {
+            TurnCosts costs;
+            if (turnCosts.is_object()) {
+                costs.turnPenalty = turnCosts.value("turn-penalty", costs.turnPenalty);
+                costs.uTurnPenalty = turnCosts.value("u-turn-penalty", costs.uTurnPenalty);
+            }
+            if (costs.turnPenalty < 0 || costs.uTurnPenalty < 0) {
+                error = "Turn penalties must not be negative";
+                return false;
+            }
+            options.turnCosts = costs;
+        }
+    } else if (body.contains("departure-time")) {
+        if (!body["departure-time"].is_number()) {
+            error = "departure-time must be a Unix timestamp in seconds";
+            return false;
+        }
+        if (body.contains("profile") && options.weighting != Weighting::CarTime) {
+            error = "departure-time is only supported for the car profile";
+            return false;
+        }
+        options.departureTime = body["departure-time"].get<double>();
+        options.utcOffset = body.value("utc-offset", 0);
+    }
+
+    // Optional count of alternative routes, only for static routing
+    if (body.contains("alternatives")) {
+        if (!body["alternatives"].is_number_unsigned()) {
+            error = "alternatives must be a non-negative number of extra routes";
+            return false;
+        }
+        if (options.turnCosts || options.departureTime) {
+            error = "alternatives cannot be combined with turn-costs or departure-time";
+            return false;
+        }
+        constexpr size_t MAX_ALTERNATIVES = 5;
+        AlternativeOptions alternatives;
+        alternatives.maxAlternatives = std::min<size_t>(body["alternatives"].get<size_t>(), MAX_ALTERNATIVES);
+        options.alternatives = alternatives;
+    }
+
+    // Optional geometry simplification, by map zoom level or tolerance in metres
+    if (body.contains("simplify")) {
+        const json& simplify = body["simplify"];
+        if (!simplify.is_object() || simplify.contains("zoom") == simplify.contains("tolerance")) {
+            error = "simplify must be an object with either a zoom level or a tolerance in metres";
+            return false;
+        }
+        SimplifyOptions simplifyOptions;
+        const std::string method = simplify.value("method", "douglas-peucker");
+        if (method == "visvalingam") {
+            simplifyOptions.method = SimplifyMethod::Visvalingam;
+        } else if (method != "douglas-peucker") {
+            error = "simplify method must be \"douglas-peucker\" or \"visvalingam\"";
+            return false;
+        }
+        if (simplify.contains("zoom")) {
+            if (!simplify["zoom"].is_number() || simplify["zoom"] < 0 || simplify["zoom"] > 24) {
+                error = "simplify zoom must be a number between 0 and 24";
+                return false;
+            }
+            options.simplifyZoom = simplify["zoom"].get<double>();
+        } else {
+            if (!simplify["tolerance"].is_number() || simplify["tolerance"] < 0) {
+                error = "simplify tolerance must be a non-negative number of metres";
+                return false;
+            }
+            simplifyOptions.tolerance = simplify["tolerance"].get<double>();
+        }
+        options.simplify = simplifyOptions;
+    }
+    return true;
+}
+
+// Apply a request's simplification to one path
+std::vector<json> simplifyRequested(const Graph& graph, const PathOptions& options, std::vector<json> path) {
+    if (!options.simplify || path.empty()) return path;
+    SimplifyOptions simplify = *options.simplify;
+    if (options.simplifyZoom) {
+        simplify.tolerance = pixelSizeAtZoom(*options.simplifyZoom, path.front()["lat"].get<double>());
+    }
+    return graph.simplifyPath(path, simplify);
+}
+
+// Node ids arrive as JSON numbers or as decimal strings
+int64_t parseNodeId(const json& value) {
+    if (value.is_string()) return std::stoll(value.get<std::string>());
+    return value.get<int64_t>();
+}
+
+// Build the /bounding-box response once the Overpass data has arrived
+crow::response loadBoundingBox(Graph& graph, const BoundingBox& bbox, const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+        async_log::debug("Parsed OSM data");
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        async_log::debug("Loading graph data");
+        graph.loadFromJSON(osmData);
+        async_log::debug("Graph data loaded", {{"nodes", graph.getNodes().size()}});
+
+
+        // Get graph state (could be sent to client)
+        json state = graph.getPathState();
+        async_log::payload(async_log::Level::Debug, "Graph state", [&state] { return state.dump(); });
+
+        // Return success response without pathfinding for now
+        json response = {
+            {"status", "success"},
+            {"message", "Map data loaded successfully"},
+            {"bounds", {
+                {"min_lat", bbox.min_lat},
+                {"min_lon", bbox.min_lon},
+                {"max_lat", bbox.max_lat},
+                {"max_lon", bbox.max_lon}
+            }},
+            // {"data", osmData},
+            // {"path", path},
+            {"state", state}
+        };
+
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+// Build the /direct-path response once the Overpass data has arrived
+crow::response routeDirectPath(Graph& graph, const json& body, const PathOptions& options,
+                               const BoundingBox& bbox, const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+        async_log::debug("Parsed OSM data");
+        const json& startNode = body["start-node"];
+        const json& endNode = body["end-node"];
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        async_log::debug("Loading graph data");
+        graph.loadFromJSON(osmData);
+        graph.verifyGraph();
+
+        // Search state is freed in one go when the request ends
+        RequestArena arena;
+        std::vector<json> path;
+        json alternatives = json::array();
+        if (options.alternatives) {
+            json routes = graph.findAlternatives(startNode, endNode, options.weighting, *options.alternatives);
+            if (!routes.empty()) {
+                path = routes[0]["path"].get<std::vector<json>>();
+                for (size_t i = 1; i < routes.size(); ++i) alternatives.push_back(std::move(routes[i]));
+            }
+        } else if (options.turnCosts) {
+            path = graph.findPath(startNode, endNode, *options.turnCosts, options.weighting, arena.resource());
+        } else if (options.departureTime) {
+            path = graph.findPath(startNode, endNode, *options.departureTime, options.utcOffset, arena.resource());
+        } else {
+            path = graph.findPath(startNode, endNode, options.weighting, arena.resource());
+        }
+        const size_t fullSize = path.size();
+        path = simplifyRequested(graph, options, std::move(path));
+        for (auto& route : alternatives) {
+            route["path"] = simplifyRequested(graph, options, route["path"].get<std::vector<json>>());
+        }
+
+        // Return success response without pathfinding for now
+        json response = {
+            {"status", "success"},
+            {"message", "Map data loaded successfully"},
+            {"bounds", {
+                {"min_lat", bbox.min_lat},
+                {"min_lon", bbox.min_lon},
+                {"max_lat", bbox.max_lat},
+                {"max_lon", bbox.max_lon}
+            }},
+            // {"data", osmData},
+            {"path", path},
+            // {"state", state}
+        };
+        if (options.alternatives) {
+            response["alternatives"] = std::move(alternatives);
+        }
+        if (options.simplify) {
+            response["simplified_from"] = fullSize;
+        }
+        if (options.departureTime && !path.empty()) {
+            response["departure_time"] = path.front()["time"];
+            response["arrival_time"] = path.back()["time"];
+            response["duration"] = path.back()["time"].get<double>() - path.front()["time"].get<double>();
+        }
+
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+// Build the /isochrone response once the Overpass data has arrived
+crow::response computeIsochrone(Graph& graph, const json& body, Weighting weighting, double budget,
+                                double cellSize, const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        graph.loadFromJSON(osmData);
+        json isochrone = graph.isochrone(body["start-node"], budget, weighting, cellSize);
+
+        json response = {
+            {"status", "success"},
+            {"budget", budget},
+            {"reached", std::move(isochrone["reached"])},
+            {"boundary", std::move(isochrone["boundary"])},
+            {"polygon", std::move(isochrone["polygon"])}
+        };
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::invalid_argument& e) {
+        return crow::response(400, e.what());
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+// Build the /k-shortest-paths response once the Overpass data has arrived
+crow::response computeKShortestPaths(Graph& graph, const json& body, size_t k, Weighting weighting,
+                                     const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        graph.loadFromJSON(osmData);
+        json paths = graph.kShortestPaths(body["start-node"], body["end-node"], k, weighting);
+
+        json response = {
+            {"status", "success"},
+            {"k", k},
+            {"paths", std::move(paths)}
+        };
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+// Validate a trace of {lat, lon} fixes before anything is fetched for it
+bool validateTrace(const json& trace, std::string& error) {
+    if (!trace.is_array() || trace.empty()) {
+        error = "trace must be a non-empty array of {lat, lon} points";
+        return false;
+    }
+    for (const auto& point : trace) {
+        if (!point.is_object() || !point.contains("lat") || !point.contains("lon")) {
+            error = "Each trace point must contain 'lat' and 'lon'";
+            return false;
+        }
+        if (!point["lat"].is_number() || !point["lon"].is_number()) {
+            error = "Latitude and longitude must be numeric values";
+            return false;
+        }
+        const double lat = point["lat"].get<double>();
+        const double lon = point["lon"].get<double>();
+        if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
+            error = "Coordinates out of valid range";
+            return false;
+        }
+    }
+    return true;
+}
+
+json matchedPointJson(const MapMatcher::MatchedPoint& point) {
+    if (!point.matched) {
+        return {{"index", point.index}, {"matched", false}};
+    }
+    return {
+        {"index", point.index},
+        {"matched", true},
+        {"from", point.from},
+        {"to", point.to},
+        {"fraction", point.fraction},
+        {"lat", point.lat},
+        {"lon", point.lon},
+        {"error", point.error}
+    };
+}
+
+// Build the /map-match response once the Overpass data has arrived
+crow::response matchTrace(Graph& graph, const json& trace, Weighting weighting, const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        graph.loadFromJSON(osmData);
+        MapMatcher matcher(graph, weighting);
+        const auto matched = matcher.match(trace);
+
+        json points = json::array();
+        for (const auto& point : matched) {
+            points.push_back(matchedPointJson(point));
+        }
+
+        json response = {
+            {"status", "success"},
+            {"points", std::move(points)}
+        };
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::invalid_argument& e) {
+        return crow::response(400, e.what());
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+// One /map-match/stream socket: a snapshot of the loaded graph and the trace matched so far
+struct MatchStream {
+    MapMatcher matcher;
+    MapMatcher::Session session;
+
+    MatchStream(const Graph& graph, Weighting weighting) : matcher(graph, weighting), session(matcher) {}
+};
+
+// Each stream holds a graph snapshot, so only this many may be open at once
+constexpr size_t MAX_MATCH_STREAMS = 16;
+std::mutex matchStreamsMutex;
+std::unordered_map<crow::websocket::connection*, std::shared_ptr<MatchStream>> matchStreams;
+
+void sendMatched(crow::websocket::connection& conn, const std::vector<MapMatcher::MatchedPoint>& matched,
+                 bool final) {
+    json points = json::array();
+    for (const auto& point : matched) {
+        points.push_back(matchedPointJson(point));
+    }
+    conn.send_text(json{{"type", "points"}, {"points", std::move(points)}, {"final", final}}.dump());
+}
+
+// Messages of /map-match/stream, in order:
+//   {"type": "start", "profile"}  match against the graph loaded now; replies {"type": "started"}
+//   {"type": "fix", "lat", "lon"} replies {"type": "points", "points": [...], "final": false}
+//                                 with the points whose match became final, possibly none
+//   {"type": "finish"}            replies with the remaining points and "final": true;
+//                                 a new "start" may follow
+// Points have the same shape as in /map-match, and their "index" counts the fixes sent.
+void onMatchMessage(Graph& graph, crow::websocket::connection& conn, const std::string& data) {
+    const json message = json::parse(data, nullptr, false);
+    if (message.is_discarded() || !message.is_object() || !message.contains("type") || !message["type"].is_string()) {
+        conn.close("Messages must be JSON objects with a type");
+        return;
+    }
+    const std::string type = message["type"];
+
+    std::shared_ptr<MatchStream> stream;
+    {
+        std::lock_guard<std::mutex> lock(matchStreamsMutex);
+        auto it = matchStreams.find(&conn);
+        if (it != matchStreams.end()) stream = it->second;
+    }
+
+    try {
+        if (type == "start") {
+            if (stream) {
+                conn.close("A trace is already being matched; finish it first");
+                return;
+            }
+            const Weighting weighting = message.contains("profile")
+                ? parseWeighting(message["profile"].get<std::string>())
+                : Weighting::CarTime;
+            {
+                // Refuse before spending time on a snapshot
+                std::lock_guard<std::mutex> lock(matchStreamsMutex);
+                if (matchStreams.size() >= MAX_MATCH_STREAMS) {
+                    conn.close("Too many map-matching streams in progress");
+                    return;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(graphMutex);
+                if (graph.getNodes().empty()) {
+                    conn.close("No graph loaded; load an area first");
+                    return;
+                }
+                stream = std::make_shared<MatchStream>(graph, weighting);
+            }
+            {
+                // Checked again, others may have started while the snapshot was taken
+                std::lock_guard<std::mutex> lock(matchStreamsMutex);
+                if (matchStreams.size() >= MAX_MATCH_STREAMS) {
+                    conn.close("Too many map-matching streams in progress");
+                    return;
+                }
+                matchStreams[&conn] = stream;
+            }
+            conn.send_text(json{{"type", "started"}}.dump());
+            return;
+        }
+
+        if (!stream) {
+            conn.close("Expected a start message");
+            return;
+        }
+        if (type == "fix") {
+            std::string error;
+            if (!validateTrace(json::array({message}), error)) {
+                conn.close(error);
+                return;
+            }
+            sendMatched(conn, stream->session.push(message["lat"].get<double>(), message["lon"].get<double>()), false);
+        } else if (type == "finish") {
+            sendMatched(conn, stream->session.finish(), true);
+            std::lock_guard<std::mutex> lock(matchStreamsMutex);
+            matchStreams.erase(&conn);
+        } else {
+            conn.close("Unknown message type");
+        }
+    } catch (const std::exception& e) {
+        async_log::warn("Map-matching stream error", {{"error", e.what()}});
+        conn.close(e.what());
+    }
+}
+
+void onMatchClose(crow::websocket::connection& conn) {
+    std::lock_guard<std::mutex> lock(matchStreamsMutex);
+    matchStreams.erase(&conn);
+}
+
+// Build the /distance-table response once the Overpass data has arrived
+crow::response computeDistanceTable(Graph& graph, const std::vector<int64_t>& sources,
+                                    const std::optional<std::vector<int64_t>>& targets,
+                                    Weighting weighting, const cpr::Response& ans) {
+    if (ans.status_code != 200) {
+        async_log::writePayload(async_log::Level::Error, "Overpass API error", ans.text, {{"status", ans.status_code}});
+        return crow::response(500, "Failed to fetch OSM data: " + ans.text);
+    }
+
+    try {
+        json osmData = json::parse(ans.text);
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        graph.loadFromJSON(osmData);
+        for (int64_t id : sources) {
+            if (!graph.getNodes().count(id)) {
+                return crow::response(400, "Source node " + std::to_string(id) + " not found in graph");
+            }
+        }
+
+        PhastEngine engine(graph, weighting);
+        const auto rows = engine.distancesFrom(sources);
+        const auto& nodeIds = engine.getNodeIds();
+
+        // Columns are either the requested targets or every node in engine order
+        std::vector<int64_t> columnIds = targets ? *targets : nodeIds;
+        std::vector<size_t> columns;
+        columns.reserve(columnIds.size());
+        if (targets) {
+            std::unordered_map<int64_t, size_t> indexOf;
+            for (size_t i = 0; i < nodeIds.size(); ++i) indexOf[nodeIds[i]] = i;
+            for (int64_t id : columnIds) {
+                auto it = indexOf.find(id);
+                if (it == indexOf.end()) {
+                    return crow::response(400, "Target node " + std::to_string(id) + " not found in graph");
+                }
+                columns.push_back(it->second);
+            }
+        } else {
+            for (size_t i = 0; i < nodeIds.size(); ++i) columns.push_back(i);
+        }
+
+        // Unreachable entries are reported as null
+        json distances = json::array();
+        for (const auto& row : rows) {
+            json values = json::array();
+            for (size_t column : columns) {
+                const float d = row[column];
+                values.push_back(std::isinf(d) ? json(nullptr) : json(d));
+            }
+            distances.push_back(std::move(values));
+        }
+
+        json response = {
+            {"status", "success"},
+            {"sources", sources},
+            {"node_ids", columnIds},
+            {"distances", std::move(distances)}
+        };
+        return crow::response(200, response.dump());
+    } catch (const json::exception& e) {
+        async_log::error("JSON parsing error", {{"error", e.what()}});
+        return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        async_log::error("Unexpected error", {{"error", e.what()}});
+        return crow::response(500, "Internal server error: " + std::string(e.what()));
+    }
+}
+
+} // namespace
+
+void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph, AsyncOverpassFetcher& fetcher,
+                 ExplorationHub& explorations) {
     // Root endpoint
     CROW_ROUTE(app, "/")([]() {
         json response = {
@@ -18,43 +657,21 @@ void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph) {
     });
 
     // POST /bounding-box endpoint
+    // Handlers reply asynchronously: the Overpass fetch runs on the fetcher's
+    // I/O pool and the response is completed from its callback on the compute pool
     CROW_ROUTE(app, "/bounding-box")
     .methods(crow::HTTPMethod::POST)
-    ([&graph](const crow::request& req) {
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
         try {
             auto body = json::parse(req.body);
-            std::cout << "Received request body: " << body.dump(2) << "\n";
-
-            // Validate request body is an array with exactly 2 elements
-            if (!body.is_array() || body.size() != 2) {
-                return crow::response(400, "Request body must be an array with exactly 2 coordinate objects");
-            }
+            async_log::payload(async_log::Level::Debug, "Received request body", [&body] { return body.dump(); });
 
-            // Validate coordinates
-            for (const auto& item : body) {
-                if (!item.contains("latitude") || !item.contains("longitude")) {
-                    return crow::response(400, "Each coordinate object must contain 'latitude' and 'longitude'");
-                }
-                if (!item["latitude"].is_number() || !item["longitude"].is_number()) {
-                    return crow::response(400, "Latitude and longitude must be numeric values");
-                }
-                
-                // Validate coordinate ranges
-                double lat = item["latitude"].get<double>();
-                double lon = item["longitude"].get<double>();
-                if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
-                    return crow::response(400, "Coordinates out of valid range");
-                }
+            BoundingBox bbox;
+            std::string error;
+            if (!parseBoundingBox(body, bbox, error)) {
+                return reply(res, crow::response(400, error));
             }
 
-            // Create bounding box
-            BoundingBox bbox {
-                std::min(body[0]["latitude"].get<double>(), body[1]["latitude"].get<double>()),
-                std::min(body[0]["longitude"].get<double>(), body[1]["longitude"].get<double>()),
-                std::max(body[0]["latitude"].get<double>(), body[1]["latitude"].get<double>()),
-                std::max(body[0]["longitude"].get<double>(), body[1]["longitude"].get<double>())
-            };
-
             // Validate bounding box size
             // const double MAX_BBOX_SIZE = 0.1; // Maximum size in degrees
             // if (bbox.max_lat - bbox.min_lat > MAX_BBOX_SIZE || 
@@ -63,186 +680,339 @@ void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph) {
             // }
 
             // Fetch OSM data
-            std::cout << "Fetching OSM data..." << "\n";
-            cpr::Response ans = OverpassDataFetcher::fetchOverpassData(bbox);
-            
-            if (ans.status_code != 200) {
-                std::cout << "Overpass API error: " << ans.status_code << " - " << ans.text << "\n";
-                return crow::response(500, "Failed to fetch OSM data: " + ans.text);
-            }
-
-            try {
-                json osmData = json::parse(ans.text);
-                std::cout << "Successfully parsed OSM data" << "\n";
-                
-                // // Clear existing graph data before loading new data
-                // graph.clear(); // Assuming you have a clear method
-                
-                std::cout << "Loading graph data..." << std::endl;
-                graph.loadFromJSON(osmData);
-                std::cout << "Graph data loaded successfully" << std::endl;
-
-
-                // Get graph state (could be sent to client)
-                json state = graph.getPathState();
-                std::cout << "Graph state: " << state.dump(2) << "\n";
-
-                // Return success response without pathfinding for now
-                json response = {
-                    {"status", "success"},
-                    {"message", "Map data loaded successfully"},
-                    {"bounds", {
-                        {"min_lat", bbox.min_lat},
-                        {"min_lon", bbox.min_lon},
-                        {"max_lat", bbox.max_lat},
-                        {"max_lon", bbox.max_lon}
-                    }},
-                    // {"data", osmData},
-                    // {"path", path},
-                    {"state", state}
-                };
-
-                return crow::response(200, response.dump());
-            } catch (const json::exception& e) {
-                std::cout << "JSON parsing error: " << e.what() << "\n";
-                return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+            async_log::debug("Fetching OSM data");
+            if (!fetcher.fetch(bbox, [&graph, &res, bbox](const cpr::Response& ans) {
+                reply(res, loadBoundingBox(graph, bbox, ans));
+            })) {
+                reply(res, busy());
             }
         }
         catch (const json::exception& e) {
-            std::cout << "Request parsing error: " << e.what() << "\n";
-            return crow::response(400, "Invalid JSON format: " + std::string(e.what()));
+            async_log::warn("Request parsing error", {{"error", e.what()}});
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
         }
         catch (const std::exception& e) {
-            std::cout << "Unexpected error: " << e.what() << "\n";
-            return crow::response(500, "Internal server error: " + std::string(e.what()));
+            async_log::error("Unexpected error", {{"error", e.what()}});
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
         }
     });
 
     CROW_ROUTE(app, "/direct-path")
     .methods(crow::HTTPMethod::POST)
-    ([&graph](const crow::request& req) {
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
         try {
             json body = json::parse(req.body);
-            std::cout << "Received request body: " << body.dump(2) << std::endl;
+            async_log::payload(async_log::Level::Debug, "Received request body", [&body] { return body.dump(); });
             json startNode = body["start-node"];
             json endNode = body["end-node"];
+
             BoundingBox bbox;
-            if (body.contains("bounding-box")){
-            
+            std::string error;
+            if (body.contains("bounding-box")) {
+                if (!parseBoundingBox(body["bounding-box"], bbox, error)) {
+                    return reply(res, crow::response(400, error));
+                }
+            } else {
+                BoundingBoxGenerator generator(startNode, endNode);
+                bbox = generator.getBoundingBox();
+            }
+
+            PathOptions options;
+            if (!parsePathOptions(body, options, error)) {
+                return reply(res, crow::response(400, error));
+            }
+
+            // Fetch OSM data
+            async_log::debug("Fetching OSM data");
+            if (!fetcher.fetch(bbox, [&graph, &res, body, options, bbox](const cpr::Response& ans) {
+                reply(res, routeDirectPath(graph, body, options, bbox, ans));
+            })) {
+                reply(res, busy());
+            }
+        }
+        catch (const json::exception& e) {
+            async_log::warn("Request parsing error", {{"error", e.what()}});
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
+        }
+        catch (const std::exception& e) {
+            async_log::error("Unexpected error", {{"error", e.what()}});
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
+        }
+    });
+
+    // POST /isochrone endpoint
+    // Body: {"start-node": {id, lat, lon}, "budget": metres for the distance
+    // profile or seconds for car/bike, "profile", "polygon", "cell-size"}
+    CROW_ROUTE(app, "/isochrone")
+    .methods(crow::HTTPMethod::POST)
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
+        try {
+            json body = json::parse(req.body);
 
-            auto boundingBoxReq = body["bounding-box"];
-            
-            // Validate request body is an array with exactly 2 elements
-            if (!boundingBoxReq.is_array() || boundingBoxReq.size() != 2) {
-                return crow::response(400, "Request body must be an array with exactly 2 coordinate objects");
+            if (!body.contains("start-node") || !body.contains("budget") || !body["budget"].is_number()) {
+                return reply(res, crow::response(400, "Request must contain start-node and a numeric budget"));
+            }
+            const double budget = body["budget"].get<double>();
+            if (budget < 0) {
+                return reply(res, crow::response(400, "budget must not be negative"));
             }
 
-            // Validate coordinates
-            for (const auto& item : boundingBoxReq) {
-                if (!item.contains("latitude") || !item.contains("longitude")) {
-                    return crow::response(400, "Each coordinate object must contain 'latitude' and 'longitude'");
+            Weighting weighting = Weighting::Distance;
+            if (body.contains("profile")) {
+                try {
+                    weighting = parseWeighting(body["profile"].get<std::string>());
+                } catch (const std::invalid_argument& e) {
+                    return reply(res, crow::response(400, e.what()));
                 }
-                if (!item["latitude"].is_number() || !item["longitude"].is_number()) {
-                    return crow::response(400, "Latitude and longitude must be numeric values");
+            }
+
+            // A cell size of 0 tells the graph to skip the polygon
+            double cellSize = 0.0;
+            if (body.value("polygon", true)) {
+                cellSize = body.value("cell-size", 50.0);
+                if (!(cellSize >= Graph::MIN_ISOCHRONE_CELL_METERS && cellSize <= Graph::MAX_ISOCHRONE_CELL_METERS)) {
+                    return reply(res, crow::response(400, "cell-size must be between 5 and 1000 metres"));
                 }
-                
-                // Validate coordinate ranges
-                double lat = item["latitude"].get<double>();
-                double lon = item["longitude"].get<double>();
-                if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
-                    return crow::response(400, "Coordinates out of valid range");
+            }
+
+            // Fetch the circle the budget could reach at the profile's top speed
+            constexpr double MAX_CAR_KMH = 130.0;
+            constexpr double MAX_BIKE_KMH = 30.0;
+            constexpr double MAX_RADIUS_KM = 25.0;
+            double radiusKm = budget / 1000.0;
+            if (weighting == Weighting::CarTime) radiusKm = budget * MAX_CAR_KMH / 3600.0;
+            if (weighting == Weighting::BikeTime) radiusKm = budget * MAX_BIKE_KMH / 3600.0;
+            BoundingBox bbox = BoundingBoxGenerator::around(body["start-node"], std::min(radiusKm, MAX_RADIUS_KM));
+
+            if (!fetcher.fetch(bbox, [&graph, &res, body, weighting, budget, cellSize](const cpr::Response& ans) {
+                reply(res, computeIsochrone(graph, body, weighting, budget, cellSize, ans));
+            })) {
+                reply(res, busy());
+            }
+        }
+        catch (const json::exception& e) {
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
+        }
+        catch (const std::invalid_argument& e) {
+            reply(res, crow::response(400, e.what()));
+        }
+        catch (const std::exception& e) {
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
+        }
+    });
+
+    // POST /k-shortest-paths endpoint
+    // Body: {"start-node", "end-node", "k", "profile", optional "bounding-box"}
+    CROW_ROUTE(app, "/k-shortest-paths")
+    .methods(crow::HTTPMethod::POST)
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
+        try {
+            json body = json::parse(req.body);
+
+            if (!body.contains("start-node") || !body.contains("end-node")) {
+                return reply(res, crow::response(400, "Request must contain start-node and end-node"));
+            }
+            constexpr size_t MAX_K = 50;
+            if (!body.contains("k") || !body["k"].is_number_unsigned() ||
+                body["k"].get<size_t>() == 0 || body["k"].get<size_t>() > MAX_K) {
+                return reply(res, crow::response(400, "k must be between 1 and " + std::to_string(MAX_K)));
+            }
+            const size_t k = body["k"].get<size_t>();
+
+            Weighting weighting = Weighting::Distance;
+            if (body.contains("profile")) {
+                try {
+                    weighting = parseWeighting(body["profile"].get<std::string>());
+                } catch (const std::invalid_argument& e) {
+                    return reply(res, crow::response(400, e.what()));
                 }
             }
 
-            // Create bounding box
-            BoundingBox bbox_ {
-                std::min(boundingBoxReq[0]["latitude"].get<double>(), boundingBoxReq[1]["latitude"].get<double>()),
-                std::min(boundingBoxReq[0]["longitude"].get<double>(), boundingBoxReq[1]["longitude"].get<double>()),
-                std::max(boundingBoxReq[0]["latitude"].get<double>(), boundingBoxReq[1]["latitude"].get<double>()),
-                std::max(boundingBoxReq[0]["longitude"].get<double>(), boundingBoxReq[1]["longitude"].get<double>())
-            };
-            bbox = bbox_;
-            }else{
-                BoundingBoxGenerator generator(startNode, endNode);
-                BoundingBox bbox = generator.getBoundingBox();
+            BoundingBox bbox;
+            std::string error;
+            if (body.contains("bounding-box")) {
+                if (!parseBoundingBox(body["bounding-box"], bbox, error)) {
+                    return reply(res, crow::response(400, error));
+                }
+            } else {
+                BoundingBoxGenerator generator(body["start-node"], body["end-node"]);
+                bbox = generator.getBoundingBox();
             }
-            // Fetch OSM data
-            std::cout << "Fetching OSM data..." << "\n";
-            cpr::Response ans = OverpassDataFetcher::fetchOverpassData(bbox);
-            
-            if (ans.status_code != 200) {
-                std::cout << "Overpass API error: " << ans.status_code << " - " << ans.text << "\n";
-                return crow::response(500, "Failed to fetch OSM data: " + ans.text);
-            }
-
-            try {
-                json osmData = json::parse(ans.text);
-                std::cout << "Successfully parsed OSM data" << "\n";
-                
-                // // Clear existing graph data before loading new data
-                // graph.clear(); // Assuming you have a clear method
-                
-                std::cout << "Loading graph data..." << std::endl;
-                graph.loadFromJSON(osmData);
-                graph.verifyGraph();
-                std::vector<json> path = graph.findPath(startNode, endNode);
-
-                // Return success response without pathfinding for now
-                json response = {
-                    {"status", "success"},
-                    {"message", "Map data loaded successfully"},
-                    {"bounds", {
-                        {"min_lat", bbox.min_lat},
-                        {"min_lon", bbox.min_lon},
-                        {"max_lat", bbox.max_lat},
-                        {"max_lon", bbox.max_lon}
-                    }},
-                    // {"data", osmData},
-                    {"path", path},
-                    // {"state", state}
-                };
-
-                return crow::response(200, response.dump());
-            } catch (const json::exception& e) {
-                std::cout << "JSON parsing error: " << e.what() << "\n";
-                return crow::response(500, "Failed to parse OSM data: " + std::string(e.what()));
+
+            if (!fetcher.fetch(bbox, [&graph, &res, body, k, weighting](const cpr::Response& ans) {
+                reply(res, computeKShortestPaths(graph, body, k, weighting, ans));
+            })) {
+                reply(res, busy());
+            }
+        }
+        catch (const json::exception& e) {
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
+        }
+        catch (const std::exception& e) {
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
+        }
+    });
+
+    // POST /map-match endpoint
+    // Body: {"trace": [{lat, lon}, ...], "profile" (default "car"), optional "bounding-box"}
+    CROW_ROUTE(app, "/map-match")
+    .methods(crow::HTTPMethod::POST)
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
+        try {
+            json body = json::parse(req.body);
+
+            std::string error;
+            if (!body.contains("trace") || !validateTrace(body["trace"], error)) {
+                return reply(res, crow::response(400, error.empty() ? "Request must contain a trace" : error));
+            }
+            const json& trace = body["trace"];
+
+            Weighting weighting = Weighting::CarTime;
+            if (body.contains("profile")) {
+                try {
+                    weighting = parseWeighting(body["profile"].get<std::string>());
+                } catch (const std::invalid_argument& e) {
+                    return reply(res, crow::response(400, e.what()));
+                }
+            }
+
+            BoundingBox bbox;
+            if (body.contains("bounding-box")) {
+                if (!parseBoundingBox(body["bounding-box"], bbox, error)) {
+                    return reply(res, crow::response(400, error));
+                }
+            } else {
+                // Extent of the trace plus a margin for the candidate radius
+                constexpr double MARGIN_DEGREES = 0.002;
+                bbox = BoundingBox{90.0, 180.0, -90.0, -180.0};
+                for (const auto& point : trace) {
+                    bbox.min_lat = std::min(bbox.min_lat, point["lat"].get<double>() - MARGIN_DEGREES);
+                    bbox.min_lon = std::min(bbox.min_lon, point["lon"].get<double>() - MARGIN_DEGREES);
+                    bbox.max_lat = std::max(bbox.max_lat, point["lat"].get<double>() + MARGIN_DEGREES);
+                    bbox.max_lon = std::max(bbox.max_lon, point["lon"].get<double>() + MARGIN_DEGREES);
+                }
+            }
+
+            if (!fetcher.fetch(bbox, [&graph, &res, trace, weighting](const cpr::Response& ans) {
+                reply(res, matchTrace(graph, trace, weighting, ans));
+            })) {
+                reply(res, busy());
+            }
+        }
+        catch (const json::exception& e) {
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
+        }
+        catch (const std::exception& e) {
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
+        }
+    });
+
+    // WebSocket /map-match/stream: matches fixes as they arrive against the
+    // graph loaded when the stream starts (see onMatchMessage)
+    CROW_WEBSOCKET_ROUTE(app, "/map-match/stream")
+    .onmessage([&graph](crow::websocket::connection& conn, const std::string& data, bool isBinary) {
+        if (isBinary) {
+            conn.close("Expected JSON text messages");
+            return;
+        }
+        onMatchMessage(graph, conn, data);
+    })
+    .onclose([](crow::websocket::connection& conn, const std::string&, uint16_t) {
+        onMatchClose(conn);
+    });
+
+    // POST /distance-table endpoint
+    // Body: {"sources": [node ids], "targets": optional [node ids], "profile",
+    // "bounding-box": [corner, corner]}. Returns one row of distances per source.
+    CROW_ROUTE(app, "/distance-table")
+    .methods(crow::HTTPMethod::POST)
+    ([&graph, &fetcher](const crow::request& req, crow::response& res) {
+        try {
+            json body = json::parse(req.body);
+
+            constexpr size_t MAX_SOURCES = 1024;
+            if (!body.contains("sources") || !body["sources"].is_array() || body["sources"].empty()) {
+                return reply(res, crow::response(400, "sources must be a non-empty array of node ids"));
+            }
+            if (body["sources"].size() > MAX_SOURCES) {
+                return reply(res, crow::response(400, "At most " + std::to_string(MAX_SOURCES) + " sources are allowed"));
+            }
+            const auto sources = body["sources"].get<std::vector<int64_t>>();
+
+            std::optional<std::vector<int64_t>> targets;
+            if (body.contains("targets")) {
+                if (!body["targets"].is_array()) {
+                    return reply(res, crow::response(400, "targets must be an array of node ids"));
+                }
+                targets = body["targets"].get<std::vector<int64_t>>();
+            }
+
+            Weighting weighting = Weighting::Distance;
+            if (body.contains("profile")) {
+                try {
+                    weighting = parseWeighting(body["profile"].get<std::string>());
+                } catch (const std::invalid_argument& e) {
+                    return reply(res, crow::response(400, e.what()));
+                }
+            }
+
+            BoundingBox bbox;
+            std::string error;
+            if (!body.contains("bounding-box")) {
+                return reply(res, crow::response(400, "Request must contain a bounding-box"));
+            }
+            if (!parseBoundingBox(body["bounding-box"], bbox, error)) {
+                return reply(res, crow::response(400, error));
+            }
+
+            if (!fetcher.fetch(bbox, [&graph, &res, sources, targets, weighting](const cpr::Response& ans) {
+                reply(res, computeDistanceTable(graph, sources, targets, weighting, ans));
+            })) {
+                reply(res, busy());
             }
         }
         catch (const json::exception& e) {
-            std::cout << "Request parsing error: " << e.what() << "\n";
-            return crow::response(400, "Invalid JSON format: " + std::string(e.what()));
+            reply(res, crow::response(400, "Invalid JSON format: " + std::string(e.what())));
         }
         catch (const std::exception& e) {
-            std::cout << "Unexpected error: " << e.what() << "\n";
-            return crow::response(500, "Internal server error: " + std::string(e.what()));
+            reply(res, crow::response(500, "Internal server error: " + std::string(e.what())));
         }
     });
 
-    // POST /start-dijkstra endpoint
+    // POST /start-dijkstra: park a search on the loaded graph for /exploration to stream
     CROW_ROUTE(app, "/start-dijkstra")
     .methods(crow::HTTPMethod::POST)
-    ([&graph](const crow::request& req) {
+    ([&graph, &explorations](const crow::request& req) {
         try {
             auto body = json::parse(req.body);
 
             if (!body.contains("start_node_id") || !body.contains("end_node_id")) {
                 return crow::response(400, "Missing start or end node ID");
             }
+            const int64_t startId = parseNodeId(body["start_node_id"]);
+            const int64_t endId = parseNodeId(body["end_node_id"]);
+            const Weighting weighting = body.contains("profile")
+                ? parseWeighting(body["profile"].get<std::string>())
+                : Weighting::Distance;
 
-            std::string start_node_id = body["start_node_id"];
-            std::string end_node_id = body["end_node_id"];
-
-            // if (!storage.validateNodeIds(start_node_id, end_node_id)) {
-            //     return crow::response(400, "Invalid node ID(s)");
-            // }
+            std::string requestId;
+            {
+                std::lock_guard<std::mutex> lock(graphMutex);
+                requestId = explorations.prepare(graph, startId, endId, weighting);
+            }
+            if (requestId.empty()) {
+                return crow::response(503, "Too many explorations in progress");
+            }
 
+            std::string host = req.get_header_value("Host");
+            if (host.empty()) host = "localhost:8080";
             json response = {
                 {"status", "success"},
                 {"message", "Pathfinding initiated"},
-                {"websocket_url", "ws://localhost:8080/exploration"},
-                {"request_id", "unique-request-id"},
-                {"start_node", start_node_id},
-                {"end_node", end_node_id}
+                {"websocket_url", "ws://" + host + "/exploration"},
+                {"request_id", requestId},
+                {"start_node", body["start_node_id"]},
+                {"end_node", body["end_node_id"]}
             };
 
             return crow::response(200, response.dump());
@@ -250,8 +1020,24 @@ void setupRoutes(crow::App<crow::CORSHandler>& app, Graph& graph) {
         catch (const json::exception& e) {
             return crow::response(400, "Invalid JSON format");
         }
+        catch (const std::invalid_argument& e) {
+            return crow::response(400, e.what());
+        }
         catch (const std::exception& e) {
             return crow::response(500, e.what());
         }
     });
+
+    // WebSocket /exploration: streams a search parked by /start-dijkstra (see exploration.hpp)
+    CROW_WEBSOCKET_ROUTE(app, "/exploration")
+    .onmessage([&explorations](crow::websocket::connection& conn, const std::string& data, bool isBinary) {
+        if (isBinary) {
+            conn.close("Expected JSON text messages");
+            return;
+        }
+        explorations.onMessage(conn, data);
+    })
+    .onclose([&explorations](crow::websocket::connection& conn, const std::string&, uint16_t) {
+        explorations.onClose(conn);
+    });
 }
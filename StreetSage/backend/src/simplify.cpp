@@ -0,0 +1,157 @@
+#include "graph.hpp"
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double EARTH_CIRCUMFERENCE = 40075016.686;
+
+struct Point {
+    double x;
+    double y;
+};
+
+// Distance from p to the segment a-b
+double segmentDistance(const Point& p, const Point& a, const Point& b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    return std::hypot(p.x - a.x - t * dx, p.y - a.y - t * dy);
+}
+
+double triangleArea(const Point& a, const Point& b, const Point& c) {
+    return std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+}
+
+// Both methods rank every point by the tolerance at which it would be
+// dropped, clamped so a point never outranks the ones it depends on. A point
+// survives a tolerance exactly when its rank exceeds it, so any zoom level is
+// a single pass over the ranks.
+
+// Douglas-Peucker with an explicit stack: the farthest point of a span is
+// ranked by its distance, capped by the rank of the point that split the span
+std::vector<double> douglasPeuckerRanks(const std::vector<Point>& points) {
+    std::vector<double> rank(points.size(), INF);
+    struct Span {
+        size_t first;
+        size_t last;
+        double cap;
+    };
+    std::vector<Span> stack = {{0, points.size() - 1, INF}};
+    while (!stack.empty()) {
+        const Span span = stack.back();
+        stack.pop_back();
+        if (span.last - span.first < 2) continue;
+
+        size_t farthest = span.first + 1;
+        double maxDistance = -1.0;
+        for (size_t i = span.first + 1; i < span.last; ++i) {
+            const double d = segmentDistance(points[i], points[span.first], points[span.last]);
+            if (d > maxDistance) {
+                maxDistance = d;
+                farthest = i;
+            }
+        }
+        rank[farthest] = std::min(maxDistance, span.cap);
+        stack.push_back({span.first, farthest, rank[farthest]});
+        stack.push_back({farthest, span.last, rank[farthest]});
+    }
+    return rank;
+}
+
+// Visvalingam-Whyatt: repeatedly drop the point with the smallest triangle,
+// never ranking a neighbour below the point just dropped
+std::vector<double> visvalingamRanks(const std::vector<Point>& points) {
+    const size_t n = points.size();
+    std::vector<double> rank(n, INF);
+    std::vector<double> area(n, INF);
+    std::vector<size_t> prev(n), next(n);
+    using Entry = std::pair<double, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (size_t i = 0; i < n; ++i) {
+        prev[i] = i - 1;
+        next[i] = i + 1;
+        if (i > 0 && i + 1 < n) {
+            area[i] = triangleArea(points[i - 1], points[i], points[i + 1]);
+            queue.push({area[i], i});
+        }
+    }
+
+    while (!queue.empty()) {
+        auto [a, i] = queue.top();
+        queue.pop();
+        if (a != area[i] || rank[i] != INF) continue;
+        rank[i] = a;
+        const size_t before = prev[i];
+        const size_t after = next[i];
+        next[before] = after;
+        prev[after] = before;
+        for (size_t j : {before, after}) {
+            if (j == 0 || j + 1 == n) continue;
+            area[j] = std::max(a, triangleArea(points[prev[j]], points[j], points[next[j]]));
+            queue.push({area[j], j});
+        }
+    }
+    return rank;
+}
+
+} // namespace
+
+double pixelSizeAtZoom(double zoom, double latitude) {
+    return EARTH_CIRCUMFERENCE * std::cos(latitude * M_PI / 180) / (512 * std::pow(2.0, zoom));
+}
+
+std::vector<json> Graph::simplifyPath(const std::vector<json>& path, const SimplifyOptions& options) const {
+    if (path.size() < 3 || options.tolerance <= 0) return path;
+
+    // Local equirectangular projection around the first point, in metres
+    const double originLat = path.front()["lat"];
+    const double metersPerDegLat = EARTH_CIRCUMFERENCE / 360;
+    const double metersPerDegLon = metersPerDegLat * std::cos(originLat * M_PI / 180);
+    std::vector<Point> points;
+    points.reserve(path.size());
+    for (const auto& step : path) {
+        points.push_back({step["lon"].get<double>() * metersPerDegLon, step["lat"].get<double>() * metersPerDegLat});
+    }
+
+    std::vector<double> rank;
+    double threshold = options.tolerance;
+    if (options.method == SimplifyMethod::Visvalingam) {
+        rank = visvalingamRanks(points);
+        threshold = options.tolerance * options.tolerance;
+    } else {
+        rank = douglasPeuckerRanks(points);
+    }
+
+    std::vector<size_t> kept;
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (rank[i] > threshold) kept.push_back(i);
+    }
+
+    // Same backwards walk as buildPath so angles are smoothed the same way;
+    // a kept point's distance covers every dropped step since the previous one
+    std::vector<json> result(kept.size());
+    double prevAngle = 0.0;
+    for (size_t k = kept.size() - 1; k > 0; --k) {
+        const json& at = path[kept[k]];
+        const json& before = path[kept[k - 1]];
+        double distance = 0.0;
+        for (size_t i = kept[k - 1] + 1; i <= kept[k]; ++i) distance += path[i]["distance"].get<double>();
+
+        const std::pair<double, double> position = {at["lat"], at["lon"]};
+        const std::pair<double, double> previous = {before["lat"], before["lon"]};
+        const double angle = calculateAngle(previous, position, previous, prevAngle);
+
+        result[k] = at;
+        result[k]["distance"] = distance;
+        result[k]["angle"] = angle;
+        prevAngle = angle;
+    }
+    result[0] = path.front();
+    return result;
+}
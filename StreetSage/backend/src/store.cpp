@@ -0,0 +1,257 @@
+#include "store.hpp"
+#include "api.hpp"
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <async_log/log.hpp>
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'O', 'P', 'T', 'S', 'v', '0', '0', '1'};
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void makeDirectory(const std::string& path) {
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create tile store directory " + path + ": " + std::strerror(errno));
+    }
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Create a uniquely named file next to path, so concurrent writers never share one
+int makeTemp(const std::string& path, std::string& tempPath) {
+    std::vector<char> name(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    name.insert(name.end(), suffix, suffix + sizeof(suffix));
+    const int fd = ::mkstemp(name.data());
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create temporary file for " + path + ": " + std::strerror(errno));
+    }
+    ::fchmod(fd, 0644);
+    tempPath = name.data();
+    return fd;
+}
+
+} // namespace
+
+OverpassTileStore::OverpassTileStore(const std::string& directory, Options options)
+    : directory(directory), options(options) {
+    makeDirectory(directory);
+    makeDirectory(directory + "/records");
+    load();
+}
+
+OverpassTileStore::~OverpassTileStore() {
+    if (indexFd >= 0) ::close(indexFd);
+}
+
+void OverpassTileStore::load() {
+    const std::string path = indexPath();
+    indexFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (indexFd < 0) {
+        throw std::runtime_error("Cannot open tile store index " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(indexFd, &info) != 0) {
+        throw std::runtime_error("Cannot stat tile store index " + path + ": " + std::strerror(errno));
+    }
+    if (info.st_size == 0) {
+        if (!writeAll(indexFd, INDEX_MAGIC, sizeof(INDEX_MAGIC))) {
+            throw std::runtime_error("Cannot initialise tile store index " + path);
+        }
+        return;
+    }
+
+    std::string contents(info.st_size, '\0');
+    if (::pread(indexFd, contents.data(), contents.size(), 0) != static_cast<ssize_t>(contents.size()) ||
+        contents.compare(0, sizeof(INDEX_MAGIC), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw std::runtime_error("Tile store index has an unknown format: " + path);
+    }
+
+    // A crash during an append can leave part of an entry at the end; drop it
+    const size_t torn = (contents.size() - sizeof(INDEX_MAGIC)) % sizeof(IndexEntry);
+    if (torn != 0) {
+        async_log::warn("Truncating torn tile store index entry", {{"bytes", torn}});
+        contents.resize(contents.size() - torn);
+        if (::ftruncate(indexFd, contents.size()) != 0) {
+            throw std::runtime_error("Cannot truncate tile store index " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    appended = (contents.size() - sizeof(INDEX_MAGIC)) / sizeof(IndexEntry);
+    live.reserve(appended);
+    for (size_t i = 0; i < appended; ++i) {
+        IndexEntry entry;
+        std::memcpy(&entry, contents.data() + sizeof(INDEX_MAGIC) + i * sizeof(IndexEntry), sizeof(IndexEntry));
+        live[entry.key] = entry;  // later entries supersede earlier ones
+    }
+    if (appended > live.size()) compact();
+}
+
+// Rewrite the index with only the live entries and swap it in atomically
+void OverpassTileStore::compact() {
+    const std::string path = indexPath();
+    std::string tempPath;
+    const int fd = makeTemp(path, tempPath);
+
+    std::string contents(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    contents.reserve(sizeof(INDEX_MAGIC) + live.size() * sizeof(IndexEntry));
+    for (const auto& [key, entry] : live) {
+        contents.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    if (!writeAll(fd, contents.data(), contents.size()) || ::fsync(fd) != 0 ||
+        ::fcntl(fd, F_SETFL, O_APPEND) != 0 || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error("Failed to compact tile store index " + path);
+    }
+
+    ::close(indexFd);
+    indexFd = fd;
+    appended = live.size();
+}
+
+BoundingBox OverpassTileStore::normalize(const BoundingBox& boundingBox) {
+    return BoundingBox{
+        std::floor(boundingBox.min_lat / GRID_DEGREES) * GRID_DEGREES,
+        std::floor(boundingBox.min_lon / GRID_DEGREES) * GRID_DEGREES,
+        std::ceil(boundingBox.max_lat / GRID_DEGREES) * GRID_DEGREES,
+        std::ceil(boundingBox.max_lon / GRID_DEGREES) * GRID_DEGREES
+    };
+}
+
+// 64-bit FNV-1a
+uint64_t OverpassTileStore::hash(const std::string& data) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string OverpassTileStore::recordPath(uint64_t key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return directory + "/records/" + name + ".z";
+}
+
+std::optional<OverpassTileStore::Record> OverpassTileStore::find(const BoundingBox& boundingBox, uint64_t queryHash) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    std::vector<const IndexEntry*> covering;
+    for (const auto& [key, entry] : live) {
+        BoundingBox covered{entry.minLat, entry.minLon, entry.maxLat, entry.maxLon};
+        if (entry.queryHash == queryHash && covered.contains(boundingBox)) covering.push_back(&entry);
+    }
+    std::sort(covering.begin(), covering.end(), [](const IndexEntry* a, const IndexEntry* b) {
+        return a->fetchedAt > b->fetchedAt;
+    });
+
+    // Prefer the newest fresh covering record, fall back to the newest readable stale one
+    const int64_t current = now();
+    for (const IndexEntry* entry : covering) {
+        if (current - entry->fetchedAt > options.maxAgeSeconds) break;
+        if (auto data = readRecord(*entry)) return Record{std::move(*data), true};
+    }
+    for (const IndexEntry* entry : covering) {
+        if (current - entry->fetchedAt <= options.maxAgeSeconds) continue;
+        if (auto data = readRecord(*entry)) return Record{std::move(*data), false};
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> OverpassTileStore::readRecord(const IndexEntry& entry) const {
+    std::ifstream file(recordPath(entry.key), std::ios::binary);
+    if (!file) return std::nullopt;
+
+    std::string compressed((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (compressed.size() != entry.compressedSize) return std::nullopt;
+
+    std::string data(entry.rawSize, '\0');
+    uLongf rawSize = entry.rawSize;
+    if (::uncompress(reinterpret_cast<Bytef*>(data.data()), &rawSize,
+                     reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()) != Z_OK ||
+        rawSize != entry.rawSize) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+void OverpassTileStore::store(const BoundingBox& boundingBox, uint64_t queryHash, const std::string& data) {
+    std::ostringstream keySource;
+    keySource.precision(10);
+    keySource << queryHash << ':' << boundingBox.min_lat << ',' << boundingBox.min_lon << ','
+              << boundingBox.max_lat << ',' << boundingBox.max_lon;
+    const uint64_t key = hash(keySource.str());
+
+    std::vector<Bytef> compressed(::compressBound(data.size()));
+    uLongf compressedSize = compressed.size();
+    if (::compress2(compressed.data(), &compressedSize,
+                    reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        throw std::runtime_error("Failed to compress Overpass response");
+    }
+
+    // Write the record under a unique temporary name and rename it so readers never see a partial file
+    const std::string path = recordPath(key);
+    std::string tempPath;
+    const int fd = makeTemp(path, tempPath);
+    const bool written = writeAll(fd, compressed.data(), compressedSize);
+    ::close(fd);
+    if (!written) {
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error("Failed to write tile store record " + tempPath);
+    }
+
+    IndexEntry entry{
+        key, queryHash,
+        boundingBox.min_lat, boundingBox.min_lon, boundingBox.max_lat, boundingBox.max_lon,
+        now(), static_cast<uint32_t>(data.size()), static_cast<uint32_t>(compressedSize)
+    };
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error("Failed to publish tile store record " + path);
+    }
+
+    const off_t end = ::lseek(indexFd, 0, SEEK_END);
+    if (!writeAll(indexFd, &entry, sizeof(entry))) {
+        if (end >= 0 && ::ftruncate(indexFd, end) != 0) {
+            async_log::warn("Cannot roll back tile store index append", {{"error", std::strerror(errno)}});
+        }
+        throw std::runtime_error("Failed to append to tile store index");
+    }
+    live[key] = entry;
+    ++appended;
+
+    if (appended >= MIN_COMPACT_ENTRIES && appended >= COMPACT_FACTOR * live.size()) compact();
+}
@@ -187,6 +187,8 @@ export default function Map() {
             "start-node": startNode,
             "end-node": node,
             "bounding-box": boundingBox,
+            // Drop shape points that would not be visible at the current zoom
+            ...(e.viewport && { simplify: { zoom: e.viewport.zoom } }),
           };
 
           const response = await fetch("http://localhost:8080/direct-path", {
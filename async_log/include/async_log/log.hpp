@@ -0,0 +1,120 @@
+#ifndef ASYNC_LOG_LOG_HPP
+#define ASYNC_LOG_LOG_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Structured logging that never blocks the logging thread. Each thread appends
+// records to its own lock-free ring; a background flusher formats them as JSON
+// lines and writes them out. A full ring drops the record and counts it, and
+// the flusher reports the count. Lines from different threads may be out of
+// time order within one flush interval; each one carries its own timestamp.
+namespace async_log {
+
+enum class Level : std::uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+// Parse "debug", "info", "warn" or "error"
+std::optional<Level> parseLevel(std::string_view name);
+const char* levelName(Level level);
+
+// A field value: integer, floating point, boolean or string
+class Value {
+public:
+    using Data = std::variant<std::int64_t, std::uint64_t, double, bool, std::string>;
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>, int> = 0>
+    Value(T value) : data(static_cast<std::int64_t>(value)) {}
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    Value(T value) : data(static_cast<std::uint64_t>(value)) {}
+    template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    Value(T value) : data(static_cast<double>(value)) {}
+    Value(bool value) : data(value) {}
+    Value(const char* value) : data(std::string(value)) {}
+    Value(std::string value) : data(std::move(value)) {}
+    Value(std::string_view value) : data(std::string(value)) {}
+
+    const Data& get() const { return data; }
+
+private:
+    Data data;
+};
+
+// One key of a record; keys are not copied, so they must be string literals
+struct Field {
+    const char* key;
+    Value value;
+};
+
+struct Options {
+    Level level = Level::Info;
+    std::size_t ringCapacity = 1024;  // records buffered per thread, for threads that log after start()
+    std::chrono::milliseconds flushInterval{50};
+    std::size_t payloadBytes = 2048;     // payloads are cut to this many bytes
+    std::uint32_t payloadSampleEvery = 1;  // keep one payload in this many
+    std::FILE* sink = stdout;
+};
+
+// Defaults overridden by LOG_LEVEL, LOG_PAYLOAD_BYTES and LOG_PAYLOAD_SAMPLE
+Options optionsFromEnvironment(Options defaults = {});
+
+// Apply the options and start the flusher. Records logged before are kept and
+// written by its first pass. Calling it again only updates the options.
+void start(const Options& options);
+
+// Write everything buffered and stop the flusher. Also runs at exit.
+void stop();
+
+// Whether records of this level are kept; check it before building expensive fields
+bool enabled(Level level);
+
+// Queue one record on the calling thread's ring
+void write(Level level, std::string message, std::initializer_list<Field> fields = {});
+
+inline void debug(std::string message, std::initializer_list<Field> fields = {}) {
+    if (enabled(Level::Debug)) write(Level::Debug, std::move(message), fields);
+}
+inline void info(std::string message, std::initializer_list<Field> fields = {}) {
+    if (enabled(Level::Info)) write(Level::Info, std::move(message), fields);
+}
+inline void warn(std::string message, std::initializer_list<Field> fields = {}) {
+    if (enabled(Level::Warn)) write(Level::Warn, std::move(message), fields);
+}
+inline void error(std::string message, std::initializer_list<Field> fields = {}) {
+    if (enabled(Level::Error)) write(Level::Error, std::move(message), fields);
+}
+
+// Whether this payload is the one in Options::payloadSampleEvery to keep
+bool samplePayload();
+
+// Queue a record with a "payload" field cut to Options::payloadBytes, plus
+// "payload_bytes" with the full size
+void writePayload(Level level, std::string message, std::string payload, std::initializer_list<Field> fields = {});
+
+/**
+ * Log a large payload such as a request body or graph state. render() returns
+ * the text and only runs for records that pass the level and the sample, so
+ * skipped payloads are never serialized.
+ */
+template <typename Render>
+void payload(Level level, std::string message, Render&& render, std::initializer_list<Field> fields = {}) {
+    if (!enabled(level) || !samplePayload()) return;
+    writePayload(level, std::move(message), std::forward<Render>(render)(), fields);
+}
+
+} // namespace async_log
+
+#endif // ASYNC_LOG_LOG_HPP
@@ -0,0 +1,324 @@
+#include "async_log/log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace async_log {
+namespace {
+
+using SystemClock = std::chrono::system_clock;
+
+struct Record {
+    Level level = Level::Info;
+    SystemClock::time_point time;
+    std::string message;
+    std::vector<Field> fields;
+};
+
+// Single-producer single-consumer ring: the owning thread pushes, the flusher
+// drains. One slot stays empty to tell full from empty.
+class Ring {
+public:
+    Ring(std::size_t capacity, std::uint32_t thread) : thread(thread), slots(std::max<std::size_t>(capacity, 1) + 1) {}
+
+    // False, and counted as dropped, when the flusher has fallen behind
+    bool push(Record&& record) {
+        const std::size_t at = head.load(std::memory_order_relaxed);
+        const std::size_t next = at + 1 == slots.size() ? 0 : at + 1;
+        if (next == tail.load(std::memory_order_acquire)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[at] = std::move(record);
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    template <typename F>
+    void drain(F&& f) {
+        std::size_t at = tail.load(std::memory_order_relaxed);
+        const std::size_t end = head.load(std::memory_order_acquire);
+        while (at != end) {
+            f(slots[at]);
+            slots[at].fields.clear();
+            at = at + 1 == slots.size() ? 0 : at + 1;
+        }
+        tail.store(at, std::memory_order_release);
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+    const std::uint32_t thread;
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<bool> orphaned{false};  // its thread has exited
+
+private:
+    std::vector<Record> slots;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+void appendEscaped(std::string& out, std::string_view text) {
+    out.push_back('"');
+    for (const char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    out += code;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendValue(std::string& out, const Value& value) {
+    std::visit([&out](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            appendEscaped(out, v);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out += v ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, double>) {
+            if (!std::isfinite(v)) {
+                out += "null";
+                return;
+            }
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.15g", v);
+            out += number;
+        } else {
+            out += std::to_string(v);
+        }
+    }, value.get());
+}
+
+// {"ts":"2024-01-01T12:00:00.000Z","level":"info","thread":1,"msg":"...",<fields>}
+void appendRecord(std::string& out, const Record& record, std::uint32_t thread) {
+    const auto since = record.time.time_since_epoch();
+    const std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(since).count();
+    const long millis = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(since).count() % 1000);
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    char stamp[32];
+    const size_t length = std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(stamp + length, sizeof(stamp) - length, ".%03ldZ", millis);
+
+    out += "{\"ts\":\"";
+    out += stamp;
+    out += "\",\"level\":\"";
+    out += levelName(record.level);
+    out += "\",\"thread\":";
+    out += std::to_string(thread);
+    out += ",\"msg\":";
+    appendEscaped(out, record.message);
+    for (const Field& field : record.fields) {
+        out.push_back(',');
+        appendEscaped(out, field.key);
+        out.push_back(':');
+        appendValue(out, field.value);
+    }
+    out += "}\n";
+}
+
+class Logger {
+public:
+    ~Logger() { stop(); }
+
+    std::atomic<int> level{static_cast<int>(Level::Info)};
+    std::atomic<std::size_t> payloadBytes{Options{}.payloadBytes};
+    std::atomic<std::uint32_t> payloadSampleEvery{Options{}.payloadSampleEvery};
+    std::atomic<std::uint64_t> payloadCount{0};
+
+    void configure(const Options& options) {
+        level.store(static_cast<int>(options.level), std::memory_order_relaxed);
+        payloadBytes.store(options.payloadBytes, std::memory_order_relaxed);
+        payloadSampleEvery.store(std::max<std::uint32_t>(options.payloadSampleEvery, 1), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        ringCapacity = options.ringCapacity;
+        flushInterval = options.flushInterval;
+        sink = options.sink;
+        if (!running) {
+            running = true;
+            flusher = std::thread([this] { run(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        if (flusher.joinable()) flusher.join();
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto snapshot = rings;
+        std::FILE* out = sink;
+        lock.unlock();
+        flush(snapshot, out);
+    }
+
+    // Wake the flusher early, e.g. for errors; does not wait for it
+    void nudge() { wake.notify_one(); }
+
+    std::shared_ptr<Ring> registerThread() {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto ring = std::make_shared<Ring>(ringCapacity, nextThread++);
+        rings.push_back(ring);
+        return ring;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            wake.wait_for(lock, flushInterval);
+            // Write without the lock, so threads registering are never held up by I/O
+            const auto snapshot = rings;
+            std::FILE* out = sink;
+            lock.unlock();
+            flush(snapshot, out);
+            lock.lock();
+            rings.erase(std::remove_if(rings.begin(), rings.end(),
+                                       [](const std::shared_ptr<Ring>& ring) {
+                                           return ring->orphaned.load(std::memory_order_acquire) && ring->empty();
+                                       }),
+                        rings.end());
+        }
+    }
+
+    void flush(const std::vector<std::shared_ptr<Ring>>& snapshot, std::FILE* out) {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        for (const auto& ring : snapshot) {
+            ring->drain([&](const Record& record) { appendRecord(buffer, record, ring->thread); });
+            if (const std::uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed)) {
+                Record notice{Level::Warn, SystemClock::now(), "Dropped log records, ring full", {}};
+                notice.fields.push_back({"dropped", dropped});
+                appendRecord(buffer, notice, ring->thread);
+            }
+        }
+        if (buffer.empty() || !out) return;
+        std::fwrite(buffer.data(), 1, buffer.size(), out);
+        std::fflush(out);
+        buffer.clear();
+    }
+
+    std::mutex mutex;  // guards everything below but the flush buffer
+    std::condition_variable wake;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::size_t ringCapacity = Options{}.ringCapacity;
+    std::chrono::milliseconds flushInterval = Options{}.flushInterval;
+    std::FILE* sink = Options{}.sink;
+    std::uint32_t nextThread = 0;
+    bool running = false;
+    std::thread flusher;
+
+    std::mutex flushMutex;  // the flusher and a final stop() must not drain at once
+    std::string buffer;
+};
+
+Logger& logger() {
+    static Logger instance;
+    return instance;
+}
+
+// The calling thread's ring, registered on its first record
+Ring& threadRing() {
+    struct Owner {
+        std::shared_ptr<Ring> ring;
+        ~Owner() {
+            if (ring) ring->orphaned.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Owner owner;
+    if (!owner.ring) owner.ring = logger().registerThread();
+    return *owner.ring;
+}
+
+std::size_t envSize(const char* name, std::size_t fallback) {
+    const char* value = std::getenv(name);
+    if (!value) return fallback;
+    char* end = nullptr;
+    const unsigned long long parsed = std::strtoull(value, &end, 10);
+    return end != value && *end == '\0' ? static_cast<std::size_t>(parsed) : fallback;
+}
+
+} // namespace
+
+std::optional<Level> parseLevel(std::string_view name) {
+    if (name == "debug") return Level::Debug;
+    if (name == "info") return Level::Info;
+    if (name == "warn") return Level::Warn;
+    if (name == "error") return Level::Error;
+    return std::nullopt;
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info: return "info";
+        case Level::Warn: return "warn";
+        case Level::Error: return "error";
+    }
+    return "unknown";
+}
+
+Options optionsFromEnvironment(Options defaults) {
+    if (const char* level = std::getenv("LOG_LEVEL")) {
+        if (const auto parsed = parseLevel(level)) defaults.level = *parsed;
+    }
+    defaults.payloadBytes = envSize("LOG_PAYLOAD_BYTES", defaults.payloadBytes);
+    defaults.payloadSampleEvery = static_cast<std::uint32_t>(envSize("LOG_PAYLOAD_SAMPLE", defaults.payloadSampleEvery));
+    return defaults;
+}
+
+void start(const Options& options) { logger().configure(options); }
+
+void stop() { logger().stop(); }
+
+bool enabled(Level level) {
+    return static_cast<int>(level) >= logger().level.load(std::memory_order_relaxed);
+}
+
+void write(Level level, std::string message, std::initializer_list<Field> fields) {
+    Record record{level, SystemClock::now(), std::move(message), std::vector<Field>(fields)};
+    threadRing().push(std::move(record));
+    if (level == Level::Error) logger().nudge();
+}
+
+bool samplePayload() {
+    Logger& instance = logger();
+    const std::uint32_t every = instance.payloadSampleEvery.load(std::memory_order_relaxed);
+    return every <= 1 || instance.payloadCount.fetch_add(1, std::memory_order_relaxed) % every == 0;
+}
+
+void writePayload(Level level, std::string message, std::string payload, std::initializer_list<Field> fields) {
+    const std::size_t size = payload.size();
+    std::size_t limit = logger().payloadBytes.load(std::memory_order_relaxed);
+    if (size > limit) {
+        // Back off to a character boundary so the cut never splits a UTF-8 sequence
+        while (limit > 0 && (static_cast<unsigned char>(payload[limit]) & 0xC0) == 0x80) --limit;
+        payload.resize(limit);
+    }
+    Record record{level, SystemClock::now(), std::move(message), std::vector<Field>(fields)};
+    record.fields.push_back({"payload", std::move(payload)});
+    record.fields.push_back({"payload_bytes", size});
+    threadRing().push(std::move(record));
+}
+
+} // namespace async_log
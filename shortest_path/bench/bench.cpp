@@ -0,0 +1,198 @@
+// Times every search specialisation the servers use on generated graphs.
+// Usage: shortest_path_bench [runs]   (median of runs, default 5)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <shortest_path/shortest_path.hpp>
+
+namespace sp = shortest_path;
+
+namespace {
+
+struct Dense {
+    std::size_t nodes;
+    std::vector<std::int32_t> full;
+    std::vector<std::uint16_t> narrow;
+    std::vector<std::int32_t> triangle;
+};
+
+// Undirected graph with about density of all pairs connected, weights 1..100
+Dense denseGraph(std::size_t V, double density, std::mt19937& rng) {
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<int> weight(1, 100);
+    Dense graph{V, std::vector<std::int32_t>(V * V, 0), {}, {}};
+    for (std::size_t u = 0; u < V; ++u) {
+        for (std::size_t v = u + 1; v < V; ++v) {
+            const int w = coin(rng) < density ? weight(rng) : 0;
+            graph.full[u * V + v] = graph.full[v * V + u] = w;
+            graph.triangle.push_back(w);
+        }
+    }
+    graph.narrow.assign(graph.full.begin(), graph.full.end());
+    return graph;
+}
+
+struct Csr {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> targets;
+    std::vector<std::int32_t> weights;
+};
+
+// Directed graph with degree random edges per node, weights 1..1000
+Csr sparseGraph(std::size_t V, std::size_t degree, std::mt19937& rng) {
+    std::uniform_int_distribution<std::uint32_t> node(0, static_cast<std::uint32_t>(V - 1));
+    std::uniform_int_distribution<int> weight(1, 1000);
+    Csr graph;
+    graph.offsets.push_back(0);
+    for (std::size_t u = 0; u < V; ++u) {
+        for (std::size_t k = 0; k < degree; ++k) {
+            graph.targets.push_back(node(rng));
+            graph.weights.push_back(weight(rng));
+        }
+        graph.offsets.push_back(static_cast<std::uint32_t>(graph.targets.size()));
+    }
+    return graph;
+}
+
+struct Road {
+    std::size_t side;
+    std::vector<double> x, y;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> targets;
+    std::vector<float> weights;
+};
+
+// side x side lattice with jittered positions, edge weight = length times 1..1.3
+Road roadGraph(std::size_t side, std::mt19937& rng) {
+    std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+    std::uniform_real_distribution<double> slowdown(1.0, 1.3);
+    Road graph;
+    graph.side = side;
+    for (std::size_t r = 0; r < side; ++r) {
+        for (std::size_t c = 0; c < side; ++c) {
+            graph.x.push_back(c + jitter(rng));
+            graph.y.push_back(r + jitter(rng));
+        }
+    }
+    graph.offsets.push_back(0);
+    const int steps[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+    for (std::size_t r = 0; r < side; ++r) {
+        for (std::size_t c = 0; c < side; ++c) {
+            const std::size_t u = r * side + c;
+            for (const auto& step : steps) {
+                const long nr = static_cast<long>(r) + step[0];
+                const long nc = static_cast<long>(c) + step[1];
+                if (nr < 0 || nc < 0 || nr >= static_cast<long>(side) || nc >= static_cast<long>(side)) continue;
+                const std::size_t v = nr * side + nc;
+                const double length = std::hypot(graph.x[u] - graph.x[v], graph.y[u] - graph.y[v]);
+                graph.targets.push_back(static_cast<std::uint32_t>(v));
+                graph.weights.push_back(static_cast<float>(length * slowdown(rng)));
+            }
+            graph.offsets.push_back(static_cast<std::uint32_t>(graph.targets.size()));
+        }
+    }
+    return graph;
+}
+
+int runs = 5;
+
+// Median time of runs calls of search(), which returns its stats
+template <typename Search>
+void bench(const char* name, std::size_t nodes, std::size_t edges, Search&& search) {
+    std::vector<double> times;
+    sp::SearchStats stats;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        stats = search();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    std::printf("%-36s %9zu %10zu %10.2f %10llu %12llu %12llu\n", name, nodes, edges, times[times.size() / 2],
+                static_cast<unsigned long long>(stats.settled), static_cast<unsigned long long>(stats.relaxations),
+                static_cast<unsigned long long>(stats.queueOperations));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1) runs = std::max(1, std::atoi(argv[1]));
+    std::mt19937 rng(42);
+
+    std::printf("%-36s %9s %10s %10s %10s %12s %12s\n", "search", "nodes", "edges", "ms", "settled", "relaxations",
+                "queue ops");
+
+    // Dense matrices, as GridGuide and DIJKSTRA_DOCKER receive them
+    const Dense dense = denseGraph(2000, 0.25, rng);
+    const std::size_t denseEdges = std::count_if(dense.full.begin(), dense.full.end(), [](int w) { return w != 0; });
+    std::vector<int> distances;
+    {
+        const sp::DenseLayout<std::int32_t> layout(dense.full.data(), dense.nodes);
+        bench("dense int32 / linear scan", dense.nodes, denseEdges,
+              [&] { return sp::dijkstra<int, sp::LinearScanQueue>(layout, 0, distances); });
+        bench("dense int32 / binary heap", dense.nodes, denseEdges,
+              [&] { return sp::dijkstra<int, sp::BinaryHeapQueue>(layout, 0, distances); });
+        bench("dense int32 / textbook trace", dense.nodes, denseEdges, [&] {
+            sp::SearchStats stats;
+            // Only the visits are counted; the trace reports improvements, not every edge looked at
+            sp::textbookDijkstra(layout, 0, distances,
+                                 [&](std::uint32_t, const std::vector<std::uint32_t>&) { ++stats.settled; });
+            return stats;
+        });
+    }
+    {
+        const sp::DenseLayout<std::uint16_t> layout(dense.narrow.data(), dense.nodes);
+        bench("dense uint16 / linear scan", dense.nodes, denseEdges,
+              [&] { return sp::dijkstra<int, sp::LinearScanQueue>(layout, 0, distances); });
+    }
+    {
+        const sp::UpperTriangleLayout<std::int32_t> layout(dense.triangle.data(), dense.nodes);
+        bench("upper triangle int32 / linear scan", dense.nodes, denseEdges,
+              [&] { return sp::dijkstra<int, sp::LinearScanQueue>(layout, 0, distances); });
+    }
+
+    // Sparse random graphs, as GridGuide's CSR endpoints receive them
+    std::vector<std::int64_t> wide;
+    {
+        const Csr small = sparseGraph(5000, 8, rng);
+        const sp::CsrLayout<std::int32_t> layout(small.offsets.data(), small.targets.data(), small.weights.data(),
+                                                 small.offsets.size() - 1);
+        bench("csr int32 / linear scan", layout.size(), small.targets.size(),
+              [&] { return sp::dijkstra<std::int64_t, sp::LinearScanQueue>(layout, 0, wide); });
+        bench("csr int32 / binary heap", layout.size(), small.targets.size(),
+              [&] { return sp::dijkstra<std::int64_t, sp::BinaryHeapQueue>(layout, 0, wide); });
+    }
+    {
+        const Csr large = sparseGraph(1000000, 8, rng);
+        const sp::CsrLayout<std::int32_t> layout(large.offsets.data(), large.targets.data(), large.weights.data(),
+                                                 large.offsets.size() - 1);
+        bench("csr int32 / binary heap", layout.size(), large.targets.size(),
+              [&] { return sp::dijkstra<std::int64_t, sp::BinaryHeapQueue>(layout, 0, wide); });
+    }
+
+    // Road-like lattice with coordinates, as StreetSage's snapshots hold, across its middle
+    {
+        const Road road = roadGraph(700, rng);
+        const sp::CsrLayout<float> layout(road.offsets.data(), road.targets.data(), road.weights.data(),
+                                          road.offsets.size() - 1);
+        const std::size_t middle = road.side / 2;
+        const std::uint32_t source = static_cast<std::uint32_t>(middle * road.side + road.side / 4);
+        const std::uint32_t target = static_cast<std::uint32_t>(middle * road.side + 3 * road.side / 4);
+        std::vector<double> lengths;
+        bench("csr float / binary heap, to target", layout.size(), road.targets.size(), [&] {
+            return sp::astar<double, sp::BinaryHeapQueue>(layout, source, target, lengths, sp::ZeroHeuristic<double>{});
+        });
+        // Weights are at least the straight-line length, so it is a consistent estimate
+        const auto euclid = sp::makeHeuristic<double>([&](std::uint32_t v) {
+            return std::hypot(road.x[v] - road.x[target], road.y[v] - road.y[target]);
+        });
+        bench("csr float / binary heap, A*", layout.size(), road.targets.size(),
+              [&] { return sp::astar<double, sp::BinaryHeapQueue>(layout, source, target, lengths, euclid); });
+    }
+    return 0;
+}
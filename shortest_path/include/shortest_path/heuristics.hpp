@@ -0,0 +1,34 @@
+#ifndef SHORTEST_PATH_HEURISTICS_HPP
+#define SHORTEST_PATH_HEURISTICS_HPP
+
+#include <cstdint>
+#include <utility>
+
+namespace shortest_path {
+
+// Heuristic policies estimate the distance left from a node to the target.
+// A search stays exact as long as the estimate is consistent: it never
+// exceeds an edge's weight plus the estimate at the edge's far end.
+
+// Plain Dijkstra
+template <typename Distance>
+struct ZeroHeuristic {
+    Distance operator()(std::uint32_t) const { return Distance(0); }
+};
+
+// A* with any callable Distance(uint32_t node)
+template <typename Distance, typename F>
+struct CallableHeuristic {
+    F estimate;
+
+    Distance operator()(std::uint32_t node) const { return static_cast<Distance>(estimate(node)); }
+};
+
+template <typename Distance, typename F>
+CallableHeuristic<Distance, typename std::decay<F>::type> makeHeuristic(F&& estimate) {
+    return {std::forward<F>(estimate)};
+}
+
+} // namespace shortest_path
+
+#endif // SHORTEST_PATH_HEURISTICS_HPP
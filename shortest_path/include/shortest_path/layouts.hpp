@@ -0,0 +1,102 @@
+#ifndef SHORTEST_PATH_LAYOUTS_HPP
+#define SHORTEST_PATH_LAYOUTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shortest_path {
+
+// Graph layouts are non-owning views. Each one exposes
+//   weight_type
+//   size()                    number of nodes
+//   forEachEdge(u, f)         calls f(v, weight, edge) for every edge leaving u,
+//                             edge being an index unique within the layout
+// and is passed to the searches as a template argument, so the edge loop is
+// inlined into them.
+
+// Row-major V x V matrix where a zero cell means no edge
+template <typename Weight>
+class DenseLayout {
+public:
+    using weight_type = Weight;
+
+    DenseLayout(const Weight* cells, std::size_t nodes) : cells(cells), nodes(nodes) {}
+
+    std::size_t size() const { return nodes; }
+
+    template <typename F>
+    void forEachEdge(std::uint32_t u, F&& f) const {
+        const std::size_t base = static_cast<std::size_t>(u) * nodes;
+        const Weight* row = cells + base;
+        for (std::uint32_t v = 0; v < nodes; ++v) {
+            if (row[v] != Weight(0)) f(v, row[v], base + v);
+        }
+    }
+
+private:
+    const Weight* cells;
+    std::size_t nodes;
+};
+
+// Undirected matrix stored as the V(V-1)/2 cells right of the diagonal, row by
+// row; a zero cell means no edge. The edge index is the cell's position.
+template <typename Weight>
+class UpperTriangleLayout {
+public:
+    using weight_type = Weight;
+
+    UpperTriangleLayout(const Weight* cells, std::size_t nodes) : cells(cells), nodes(nodes) {}
+
+    std::size_t size() const { return nodes; }
+
+    // Position of cell (u, u + 1), the first of row u
+    static std::size_t rowStart(std::size_t nodes, std::size_t u) { return u * nodes - u * (u + 1) / 2; }
+
+    template <typename F>
+    void forEachEdge(std::uint32_t u, F&& f) const {
+        // (v, u) for v < u: column u, each row one cell shorter than the last
+        std::size_t cell = static_cast<std::size_t>(u) - 1;
+        for (std::uint32_t v = 0; v < u; ++v) {
+            if (cells[cell] != Weight(0)) f(v, cells[cell], cell);
+            cell += nodes - v - 2;
+        }
+        // (u, v) for v > u: contiguous
+        cell = rowStart(nodes, u);
+        for (std::uint32_t v = u + 1; v < nodes; ++v, ++cell) {
+            if (cells[cell] != Weight(0)) f(v, cells[cell], cell);
+        }
+    }
+
+private:
+    const Weight* cells;
+    std::size_t nodes;
+};
+
+// Compressed sparse rows: the edges leaving u are targets[offsets[u]] ..
+// targets[offsets[u + 1] - 1] with matching weights; every edge counts,
+// including zero weights
+template <typename Weight>
+class CsrLayout {
+public:
+    using weight_type = Weight;
+
+    CsrLayout(const std::uint32_t* offsets, const std::uint32_t* targets, const Weight* weights, std::size_t nodes)
+        : offsets(offsets), targets(targets), weights(weights), nodes(nodes) {}
+
+    std::size_t size() const { return nodes; }
+
+    template <typename F>
+    void forEachEdge(std::uint32_t u, F&& f) const {
+        for (std::uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) f(targets[e], weights[e], e);
+    }
+
+private:
+    const std::uint32_t* offsets;
+    const std::uint32_t* targets;
+    const Weight* weights;
+    std::size_t nodes;
+};
+
+} // namespace shortest_path
+
+#endif // SHORTEST_PATH_LAYOUTS_HPP
@@ -0,0 +1,109 @@
+#ifndef SHORTEST_PATH_QUEUES_HPP
+#define SHORTEST_PATH_QUEUES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace shortest_path {
+
+// Distance arithmetic shared by the queues and searches. Unreachable is the
+// largest value of the type (infinity for floating point), and sums that would
+// pass it saturate to it.
+template <typename Distance, bool Floating = std::is_floating_point<Distance>::value>
+struct DistanceTraits {
+    static Distance unreachable() { return std::numeric_limits<Distance>::max(); }
+
+    template <typename Weight>
+    static Distance add(Distance distance, Weight weight) {
+        const Distance step = static_cast<Distance>(weight);
+        return step > unreachable() - distance ? unreachable() : distance + step;
+    }
+};
+
+template <typename Distance>
+struct DistanceTraits<Distance, true> {
+    static Distance unreachable() { return std::numeric_limits<Distance>::infinity(); }
+
+    template <typename Weight>
+    static Distance add(Distance distance, Weight weight) { return distance + static_cast<Distance>(weight); }
+};
+
+// Queue policies order the nodes a search settles. Each one offers
+//   Queue(nodes)
+//   push(node, key)   a new or lower key for node
+//   pop(node)         false once empty; may return nodes that were already
+//                     settled, which the search skips
+//   operations()      heap pushes and pops so far
+
+// Binary heap with lazy deletion: a lower key pushes a second entry and the
+// stale one is skipped when it surfaces. O(log V) per operation; ties pop the
+// lowest node id first.
+template <typename Distance>
+class BinaryHeapQueue {
+public:
+    explicit BinaryHeapQueue(std::size_t) {}
+
+    void push(std::uint32_t node, Distance key) {
+        heap.emplace(key, node);
+        ++count;
+    }
+
+    bool pop(std::uint32_t& node) {
+        if (heap.empty()) return false;
+        node = heap.top().second;
+        heap.pop();
+        ++count;
+        return true;
+    }
+
+    std::uint64_t operations() const { return count; }
+
+private:
+    using Entry = std::pair<Distance, std::uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::uint64_t count = 0;
+};
+
+// One key per node, scanned in full for every pop: O(V) per pop and O(1) per
+// push, the right trade for dense graphs. A popped node's key is reset to
+// unreachable, which doubles as the visited mark. Ties pop the highest node id,
+// as the textbook loop does. Has no heap, so reports no operations.
+template <typename Distance>
+class LinearScanQueue {
+public:
+    explicit LinearScanQueue(std::size_t nodes) : keys(nodes, DistanceTraits<Distance>::unreachable()) {}
+
+    void push(std::uint32_t node, Distance key) { keys[node] = key; }
+
+    bool pop(std::uint32_t& node) {
+        const Distance none = DistanceTraits<Distance>::unreachable();
+        const std::size_t V = keys.size();
+        Distance best = none;
+        std::size_t found = V;
+        for (std::size_t v = 0; v < V; ++v) {
+            if (keys[v] <= best && keys[v] != none) {
+                best = keys[v];
+                found = v;
+            }
+        }
+        if (found == V) return false;
+        keys[found] = none;
+        node = static_cast<std::uint32_t>(found);
+        return true;
+    }
+
+    std::uint64_t operations() const { return 0; }
+
+private:
+    std::vector<Distance> keys;
+};
+
+} // namespace shortest_path
+
+#endif // SHORTEST_PATH_QUEUES_HPP
@@ -0,0 +1,98 @@
+#ifndef SHORTEST_PATH_SEARCH_HPP
+#define SHORTEST_PATH_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "heuristics.hpp"
+#include "queues.hpp"
+
+namespace shortest_path {
+
+// Target of a search that should settle everything it can reach
+constexpr std::uint32_t NO_TARGET = std::numeric_limits<std::uint32_t>::max();
+
+// Effort of one search. A node is settled when its distance is final, a
+// relaxation is one look at an edge, and queue operations are the queue's own count.
+struct SearchStats {
+    std::uint64_t settled = 0;
+    std::uint64_t relaxations = 0;
+    std::uint64_t queueOperations = 0;
+};
+
+// Hooks a search calls as it goes; derive and hide the ones you need
+struct SearchVisitor {
+    // u's distance is final and its edges are next; false stops the search first
+    bool settle(std::uint32_t) { return true; }
+    // The edge from u lowered v's distance
+    void improve(std::uint32_t, std::uint32_t, std::size_t) {}
+    // Every edge of u has been relaxed; false stops the search
+    bool scanned(std::uint32_t) { return true; }
+};
+
+/**
+ * Label-setting search from source over any layout, ordered by any queue
+ * policy and heuristic. Stops once target is settled, when the visitor asks,
+ * or when the queue runs dry; a source outside the graph reaches nothing.
+ * Weights must not be negative.
+ * @param distances Receives the distance of every node, DistanceTraits<Distance>::unreachable()
+ *                  for those not reached; written in place, so the visitor may read it
+ */
+template <typename Distance, template <typename> class Queue, typename Layout, typename Heuristic, typename Visitor>
+SearchStats search(const Layout& graph, std::uint32_t source, std::uint32_t target, std::vector<Distance>& distances,
+                   const Heuristic& heuristic, Visitor& visitor) {
+    using Traits = DistanceTraits<Distance>;
+    const std::size_t V = graph.size();
+    distances.assign(V, Traits::unreachable());
+    std::vector<char> settled(V, 0);
+    Queue<Distance> queue(V);
+    SearchStats stats;
+    if (source >= V) return stats;
+
+    distances[source] = Distance(0);
+    queue.push(source, heuristic(source));
+
+    std::uint32_t u;
+    while (queue.pop(u)) {
+        // Stale entry left behind by a later improvement
+        if (settled[u]) continue;
+        settled[u] = 1;
+        ++stats.settled;
+        if (!visitor.settle(u) || u == target) break;
+
+        const Distance du = distances[u];
+        graph.forEachEdge(u, [&](std::uint32_t v, typename Layout::weight_type weight, std::size_t edge) {
+            ++stats.relaxations;
+            if (settled[v]) return;
+            const Distance candidate = Traits::add(du, weight);
+            if (candidate < distances[v]) {
+                distances[v] = candidate;
+                queue.push(v, Traits::add(candidate, heuristic(v)));
+                visitor.improve(u, v, edge);
+            }
+        });
+        if (!visitor.scanned(u)) break;
+    }
+    stats.queueOperations = queue.operations();
+    return stats;
+}
+
+// Dijkstra from source to every node it reaches
+template <typename Distance, template <typename> class Queue, typename Layout>
+SearchStats dijkstra(const Layout& graph, std::uint32_t source, std::vector<Distance>& distances) {
+    SearchVisitor visitor;
+    return search<Distance, Queue>(graph, source, NO_TARGET, distances, ZeroHeuristic<Distance>{}, visitor);
+}
+
+// A* from source until target is settled
+template <typename Distance, template <typename> class Queue, typename Layout, typename Heuristic>
+SearchStats astar(const Layout& graph, std::uint32_t source, std::uint32_t target, std::vector<Distance>& distances,
+                  const Heuristic& heuristic) {
+    SearchVisitor visitor;
+    return search<Distance, Queue>(graph, source, target, distances, heuristic, visitor);
+}
+
+} // namespace shortest_path
+
+#endif // SHORTEST_PATH_SEARCH_HPP
@@ -0,0 +1,13 @@
+#ifndef SHORTEST_PATH_SHORTEST_PATH_HPP
+#define SHORTEST_PATH_SHORTEST_PATH_HPP
+
+// Header-only shortest path searches shared by the GridGuide, DIJKSTRA_DOCKER
+// and StreetSage servers. A search is specialised on its distance type, graph
+// layout (layouts.hpp), queue policy (queues.hpp) and heuristic (heuristics.hpp).
+#include "heuristics.hpp"
+#include "layouts.hpp"
+#include "queues.hpp"
+#include "search.hpp"
+#include "textbook.hpp"
+
+#endif // SHORTEST_PATH_SHORTEST_PATH_HPP
@@ -0,0 +1,54 @@
+#ifndef SHORTEST_PATH_TEXTBOOK_HPP
+#define SHORTEST_PATH_TEXTBOOK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "search.hpp"
+
+namespace shortest_path {
+
+/**
+ * The O(V^2) loop the visualizers animate: exactly V - 1 iterations, each
+ * picking the unvisited node with the smallest distance (ties to the highest
+ * index) and relaxing its edges. Once nothing reachable is left the remaining
+ * nodes are still visited, from the highest index down, without relaxing anything.
+ * @param iteration Called as iteration(u, relaxed) after each visit, relaxed
+ *                  being the nodes u lowered in edge order; distances is current by then
+ */
+template <typename Distance, typename Layout, typename F>
+void textbookDijkstra(const Layout& graph, std::uint32_t source, std::vector<Distance>& distances, F&& iteration) {
+    struct Trace : SearchVisitor {
+        F& iteration;
+        std::size_t remaining;
+        std::vector<std::uint32_t> relaxed;
+
+        Trace(F& iteration, std::size_t remaining) : iteration(iteration), remaining(remaining) {}
+
+        bool settle(std::uint32_t) {
+            relaxed.clear();
+            return remaining > 0;
+        }
+        void improve(std::uint32_t, std::uint32_t v, std::size_t) { relaxed.push_back(v); }
+        bool scanned(std::uint32_t u) {
+            iteration(u, static_cast<const std::vector<std::uint32_t>&>(relaxed));
+            return --remaining > 0;
+        }
+    };
+
+    const std::size_t V = graph.size();
+    Trace trace(iteration, V > 0 ? V - 1 : 0);
+    search<Distance, LinearScanQueue>(graph, source, NO_TARGET, distances, ZeroHeuristic<Distance>{}, trace);
+
+    // Whatever is still unreachable, highest index first
+    trace.relaxed.clear();
+    for (std::size_t u = V; u-- > 0 && trace.remaining > 0;) {
+        if (distances[u] != DistanceTraits<Distance>::unreachable()) continue;
+        iteration(static_cast<std::uint32_t>(u), static_cast<const std::vector<std::uint32_t>&>(trace.relaxed));
+        --trace.remaining;
+    }
+}
+
+} // namespace shortest_path
+
+#endif // SHORTEST_PATH_TEXTBOOK_HPP